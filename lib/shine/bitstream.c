@@ -19,6 +19,7 @@ void shine_open_bit_stream(bitstream_t *bs, int size) {
   bs->data = (unsigned char *)malloc(size * sizeof(unsigned char));
   bs->data_size = size;
   bs->data_position = 0;
+  bs->data_high_water = 0;
   bs->cache = 0;
   bs->cache_bits = 32;
 }
@@ -74,3 +75,25 @@ void shine_putbits(bitstream_t *bs, unsigned int val, unsigned int N) {
 int shine_get_bits_count(bitstream_t *bs) {
   return bs->data_position * 8 + 32 - bs->cache_bits;
 }
+
+/*
+ * shine_flush_bits:
+ * --------
+ * move the whole bytes still held in the cache to the buffer. Frames are
+ * byte aligned, so after a complete frame this empties the cache.
+ * shine_putbits stores 32 bit words at data_position, so only call this
+ * right before data_position is reset to 0.
+ */
+void shine_flush_bits(bitstream_t *bs) {
+  while (bs->cache_bits <= 24) {
+    if (bs->data_position + 1 >= bs->data_size) {
+      bs->data = (unsigned char *)realloc(bs->data,
+                                          bs->data_size + (bs->data_size / 2));
+      bs->data_size += (bs->data_size / 2);
+    }
+
+    bs->data[bs->data_position++] = (unsigned char)(bs->cache >> 24);
+    bs->cache <<= 8;
+    bs->cache_bits += 8;
+  }
+}
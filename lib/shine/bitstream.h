@@ -5,6 +5,7 @@ typedef struct bit_stream_struc {
   unsigned char *data; /* Processed data */
   int data_size;       /* Total data size */
   int data_position;   /* Data position */
+  int data_high_water; /* Highest data position reached */
   unsigned int cache;  /* bit stream cache */
   int cache_bits;      /* free bits in cache */
 } bitstream_t;
@@ -25,5 +26,6 @@ void shine_open_bit_stream(bitstream_t *bs, const int size);
 void shine_close_bit_stream(bitstream_t *bs);
 void shine_putbits(bitstream_t *bs, unsigned int val, unsigned int N);
 int shine_get_bits_count(bitstream_t *bs);
+void shine_flush_bits(bitstream_t *bs);
 
 #endif
@@ -32,8 +32,8 @@ static void Huffmancodebits(shine_global_config *config, int *ix, gr_info *gi);
 void shine_format_bitstream(shine_global_config *config) {
   int gr, ch, i;
 
-  for (ch = 0; ch < config->wave.channels; ch++)
-    for (gr = 0; gr < config->mpeg.granules_per_frame; gr++) {
+  for (ch = 0; ch < SHINE_CHANNELS(config); ch++)
+    for (gr = 0; gr < SHINE_GRANULES(config); gr++) {
       int *pi = &config->l3_enc[ch][gr][0];
       int32_t *pr = &config->mdct_freq[ch][gr][0];
       for (i = 0; i < GRANULE_SIZE; i++) {
@@ -50,8 +50,8 @@ static void encodeMainData(shine_global_config *config) {
   int gr, ch, sfb;
   shine_side_info_t si = config->side_info;
 
-  for (gr = 0; gr < config->mpeg.granules_per_frame; gr++) {
-    for (ch = 0; ch < config->wave.channels; ch++) {
+  for (gr = 0; gr < SHINE_GRANULES(config); gr++) {
+    for (ch = 0; ch < SHINE_CHANNELS(config); ch++) {
       gr_info *gi = &(si.gr[gr].ch[ch].tt);
       unsigned slen1 = shine_slen1_tab[gi->scalefac_compress];
       unsigned slen2 = shine_slen2_tab[gi->scalefac_compress];
@@ -93,34 +93,34 @@ static void encodeSideInfo(shine_global_config *config) {
   shine_putbits(&config->bs, config->mpeg.original, 1);
   shine_putbits(&config->bs, config->mpeg.emph, 2);
 
-  if (config->mpeg.version == MPEG_I) {
+  if (SHINE_IS_MPEG_I(config)) {
     shine_putbits(&config->bs, 0, 9);
-    if (config->wave.channels == 2)
+    if (SHINE_CHANNELS(config) == 2)
       shine_putbits(&config->bs, si.private_bits, 3);
     else
       shine_putbits(&config->bs, si.private_bits, 5);
   } else {
     shine_putbits(&config->bs, 0, 8);
-    if (config->wave.channels == 2)
+    if (SHINE_CHANNELS(config) == 2)
       shine_putbits(&config->bs, si.private_bits, 2);
     else
       shine_putbits(&config->bs, si.private_bits, 1);
   }
 
-  if (config->mpeg.version == MPEG_I)
-    for (ch = 0; ch < config->wave.channels; ch++) {
+  if (SHINE_IS_MPEG_I(config))
+    for (ch = 0; ch < SHINE_CHANNELS(config); ch++) {
       for (scfsi_band = 0; scfsi_band < 4; scfsi_band++)
         shine_putbits(&config->bs, si.scfsi[ch][scfsi_band], 1);
     }
 
-  for (gr = 0; gr < config->mpeg.granules_per_frame; gr++)
-    for (ch = 0; ch < config->wave.channels; ch++) {
+  for (gr = 0; gr < SHINE_GRANULES(config); gr++)
+    for (ch = 0; ch < SHINE_CHANNELS(config); ch++) {
       gr_info *gi = &(si.gr[gr].ch[ch].tt);
 
       shine_putbits(&config->bs, gi->part2_3_length, 12);
       shine_putbits(&config->bs, gi->big_values, 9);
       shine_putbits(&config->bs, gi->global_gain, 8);
-      if (config->mpeg.version == MPEG_I)
+      if (SHINE_IS_MPEG_I(config))
         shine_putbits(&config->bs, gi->scalefac_compress, 4);
       else
         shine_putbits(&config->bs, gi->scalefac_compress, 9);
@@ -132,7 +132,7 @@ static void encodeSideInfo(shine_global_config *config) {
       shine_putbits(&config->bs, gi->region0_count, 4);
       shine_putbits(&config->bs, gi->region1_count, 3);
 
-      if (config->mpeg.version == MPEG_I)
+      if (SHINE_IS_MPEG_I(config))
         shine_putbits(&config->bs, gi->preflag, 1);
       shine_putbits(&config->bs, gi->scalefac_scale, 1);
       shine_putbits(&config->bs, gi->count1table_select, 1);
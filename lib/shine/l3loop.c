@@ -101,8 +101,10 @@ void shine_iteration_loop(shine_global_config *config) {
   int ch, gr, i;
   int *ix;
 
-  for (ch = config->wave.channels; ch--;) {
-    for (gr = 0; gr < config->mpeg.granules_per_frame; gr++) {
+  config->frame_xrmax = 0;
+
+  for (ch = SHINE_CHANNELS(config); ch--;) {
+    for (gr = 0; gr < SHINE_GRANULES(config); gr++) {
       /* setup pointers */
       ix = config->l3_enc[ch][gr];
       config->l3loop.xr = config->mdct_freq[ch][gr];
@@ -117,13 +119,15 @@ void shine_iteration_loop(shine_global_config *config) {
         if (config->l3loop.xrabs[i] > config->l3loop.xrmax)
           config->l3loop.xrmax = config->l3loop.xrabs[i];
       }
+      if (config->l3loop.xrmax > config->frame_xrmax)
+        config->frame_xrmax = config->l3loop.xrmax;
 
       cod_info = (gr_info *)&(config->side_info.gr[gr].ch[ch]);
       cod_info->sfb_lmax = SFB_LMAX - 1; /* gr_deco */
 
       calc_xmin(&config->ratio, cod_info, &l3_xmin, gr, ch);
 
-      if (config->mpeg.version == MPEG_I)
+      if (SHINE_IS_MPEG_I(config))
         calc_scfsi(&l3_xmin, ch, gr, config);
 
       /* calculation of number of available bit( per granule ) */
@@ -56,8 +56,8 @@ void shine_mdct_sub(shine_global_config *config, int stride) {
   int ch, gr, band, j, k;
   int32_t mdct_in[36];
 
-  for (ch = config->wave.channels; ch--;) {
-    for (gr = 0; gr < config->mpeg.granules_per_frame; gr++) {
+  for (ch = SHINE_CHANNELS(config); ch--;) {
+    for (gr = 0; gr < SHINE_GRANULES(config); gr++) {
       /* set up pointer to the part of config->mdct_freq we're using */
       mdct_enc = (int32_t(*)[18])config->mdct_freq[ch][gr];
 
@@ -143,7 +143,7 @@ void shine_mdct_sub(shine_global_config *config, int stride) {
 
     /* Save latest granule's subband samples to be used in the next mdct call */
     memcpy(config->l3_sb_sample[ch][0],
-           config->l3_sb_sample[ch][config->mpeg.granules_per_frame],
+           config->l3_sb_sample[ch][SHINE_GRANULES(config)],
            sizeof(config->l3_sb_sample[0][0]));
   }
 }
@@ -0,0 +1,166 @@
+/* l3stream.c
+ * Frame accumulator on top of the layer III encoder, see l3stream.h
+ */
+
+#include "l3stream.h"
+#include "types.h"
+
+struct shine_stream {
+  shine_t enc;
+  int channels;
+  int samples_per_pass;
+  int fill;    /* samples per channel waiting in pcm */
+  long frames; /* frames encoded so far */
+  long offset; /* stream offset of the next frame */
+  shine_stream_write_cb cb;
+  shine_stream_frame_cb frame_cb;
+  void *user;
+  int16_t pcm[SHINE_MAX_SAMPLES * MAX_CHANNELS]; /* interleaved */
+};
+
+#ifdef SHINE_RAM_BUDGET
+/* Build-time memory budget (bytes) for one stream encoder with its initial
+ * output buffer. Fails to compile when it outgrows it, see
+ * shine_stream_get_footprint() for the runtime figures. */
+typedef char shine_ram_budget_exceeded
+    [(sizeof(shine_global_config) + BUFFER_SIZE +
+      sizeof(struct shine_stream) <= SHINE_RAM_BUDGET) ? 1 : -1];
+#endif
+
+shine_stream_t shine_stream_open(shine_config_t *config,
+                                 shine_stream_write_cb cb, void *user) {
+  shine_stream_t st;
+
+  if (config->wave.channels > MAX_CHANNELS)
+    return NULL;
+
+  st = calloc(1, sizeof(struct shine_stream));
+  if (st == NULL)
+    return st;
+
+  st->enc = shine_initialise(config);
+  if (st->enc == NULL) {
+    free(st);
+    return NULL;
+  }
+
+  st->channels = config->wave.channels;
+  st->samples_per_pass = shine_samples_per_pass(st->enc);
+  st->fill = 0;
+  st->cb = cb;
+  st->user = user;
+
+  return st;
+}
+
+int shine_stream_samples_per_pass(shine_stream_t st) {
+  return st->samples_per_pass;
+}
+
+void shine_stream_on_frame(shine_stream_t st, shine_stream_frame_cb cb) {
+  st->frame_cb = cb;
+}
+
+shine_t shine_stream_encoder(shine_stream_t st) { return st->enc; }
+
+void shine_stream_get_footprint(shine_stream_t st,
+                                shine_footprint_t *footprint) {
+  shine_get_footprint(st->enc, footprint);
+  footprint->stream = sizeof(struct shine_stream);
+  footprint->total += footprint->stream;
+}
+
+/* Encode one frame from `data` and describe it in `frame`. */
+static void encode_frame(shine_stream_t st, int16_t *data,
+                         shine_stream_frame_t *frame) {
+  int written;
+
+  frame->data = shine_encode_buffer_interleaved(st->enc, data, &written);
+  frame->len = written;
+  frame->pts = st->frames * st->samples_per_pass;
+
+  shine_last_frame_info(st->enc, &frame->info);
+  frame->info.index = st->frames++;
+  frame->info.offset = st->offset;
+  st->offset += frame->info.bytes;
+}
+
+/* Hand a frame to the callbacks of the push interface. */
+static void deliver_frame(shine_stream_t st, shine_stream_frame_t *frame) {
+  if (st->frame_cb)
+    st->frame_cb(&frame->info, st->user);
+  if (frame->len > 0 && st->cb)
+    st->cb(frame->data, frame->len, st->user);
+}
+
+int shine_stream_pull(shine_stream_t st, const int16_t **data, int *samples,
+                      shine_stream_frame_t *frame) {
+  int n;
+
+  while (*samples > 0) {
+    /* Whole frames straight from the caller's buffer, no copy needed.
+     * The encoder only reads from the buffer. */
+    if (st->fill == 0 && *samples >= st->samples_per_pass) {
+      encode_frame(st, (int16_t *)*data, frame);
+      *data += st->samples_per_pass * st->channels;
+      *samples -= st->samples_per_pass;
+      return 1;
+    }
+
+    /* Top up the accumulator. */
+    n = MIN(*samples, st->samples_per_pass - st->fill);
+    memcpy(st->pcm + st->fill * st->channels, *data,
+           n * st->channels * sizeof(int16_t));
+    st->fill += n;
+    *data += n * st->channels;
+    *samples -= n;
+
+    if (st->fill == st->samples_per_pass) {
+      encode_frame(st, st->pcm, frame);
+      st->fill = 0;
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+int shine_stream_write(shine_stream_t st, const int16_t *data, int samples) {
+  shine_stream_frame_t frame;
+  int frames = 0;
+
+  while (shine_stream_pull(st, &data, &samples, &frame)) {
+    deliver_frame(st, &frame);
+    frames++;
+  }
+
+  return frames;
+}
+
+int shine_stream_flush(shine_stream_t st) {
+  shine_stream_frame_t frame;
+  unsigned char *out;
+  int written;
+  int frames = 0;
+
+  if (st->fill > 0) {
+    /* Pad the last partial frame with silence. */
+    memset(st->pcm + st->fill * st->channels, 0,
+           (st->samples_per_pass - st->fill) * st->channels * sizeof(int16_t));
+    encode_frame(st, st->pcm, &frame);
+    deliver_frame(st, &frame);
+    st->fill = 0;
+    frames++;
+  }
+
+  out = shine_flush(st->enc, &written);
+  if (written > 0 && st->cb)
+    st->cb(out, written, st->user);
+
+  return frames;
+}
+
+void shine_stream_close(shine_stream_t st) {
+  shine_close(st->enc);
+  free(st);
+}
@@ -0,0 +1,89 @@
+#ifndef L3STREAM_H
+#define L3STREAM_H
+
+#include "layer3.h"
+
+/* Streaming front-end for the layer III encoder.
+ *
+ * `shine_encode_buffer` expects exactly `shine_samples_per_pass` samples per
+ * call. The stream wrapper keeps a one frame accumulator so that the
+ * application can feed PCM in chunks of any length (for instance whatever
+ * the I2S DMA returned) and encoded data is handed out through a callback as
+ * soon as a frame is complete. */
+
+/* Abstract type for the stream handle. */
+typedef struct shine_stream *shine_stream_t;
+
+/* Receives encoded MP3 data. `data` is only valid during the call. */
+typedef void (*shine_stream_write_cb)(const unsigned char *data, int len,
+                                      void *user);
+
+/* Receives the analysis values of every encoded frame, with `index` and
+ * `offset` filled in. Called before the frame's data reaches the write
+ * callback. */
+typedef void (*shine_stream_frame_cb)(const shine_frame_info_t *info,
+                                      void *user);
+
+/* One encoded frame, see `shine_stream_pull`. */
+typedef struct {
+  const unsigned char *data; /* Valid until the next call on the stream */
+  int len;
+  long pts; /* Position of the frame's first sample, in samples */
+  shine_frame_info_t info;
+} shine_stream_frame_t;
+
+/* Open a stream encoder. The configuration is passed to `shine_initialise`
+ * and `cb` is called with `user` for every chunk of encoded data.
+ *
+ * Returns NULL if the configuration is not supported or if memory could not
+ * be allocated. */
+shine_stream_t shine_stream_open(shine_config_t *config,
+                                 shine_stream_write_cb cb, void *user);
+
+/* Returns audio samples (per channel) consumed by each encoded frame. */
+int shine_stream_samples_per_pass(shine_stream_t st);
+
+/* Install a per frame callback, called with the `user` pointer given to
+ * `shine_stream_open`. Pass NULL to remove it. */
+void shine_stream_on_frame(shine_stream_t st, shine_stream_frame_cb cb);
+
+/* Returns the underlying encoder handle, for instance to query
+ * `shine_get_footprint`. It stays owned by the stream. */
+shine_t shine_stream_encoder(shine_stream_t st);
+
+/* Like `shine_get_footprint` on the underlying encoder, with the stream
+ * wrapper and its PCM accumulator added as the `stream` component. */
+void shine_stream_get_footprint(shine_stream_t st,
+                                shine_footprint_t *footprint);
+
+/* Feed interleaved PCM data. `samples` is the number of samples per channel
+ * and may be any value, including zero. Complete frames are encoded right
+ * away, the remainder is kept until the next call.
+ *
+ * Returns the number of frames encoded during this call. */
+int shine_stream_write(shine_stream_t st, const int16_t *data, int samples);
+
+/* Pull interface: consume PCM from `*data` until one frame is encoded.
+ * `*data` and `*samples` are advanced past the consumed input.
+ *
+ * Returns 1 with `frame` filled in when a frame was encoded, 0 once the input
+ * is used up (the remainder is kept for the next call). Callbacks are not
+ * called. Combine with `shine_set_low_latency` on `shine_stream_encoder` to
+ * get exactly one frame of data per pulled frame. */
+int shine_stream_pull(shine_stream_t st, const int16_t **data, int *samples,
+                      shine_stream_frame_t *frame);
+
+/* End of stream: pad the buffered partial frame with silence, encode it and
+ * flush all remaining data to the callbacks, also when the pull interface
+ * was used so far. Samples written afterwards start
+ * a new frame.
+ *
+ * Returns the number of frames encoded during this call. */
+int shine_stream_flush(shine_stream_t st);
+
+/* Close the stream and the underlying encoder, freeing all associated memory.
+ * Pending samples are discarded, call `shine_stream_flush` first to keep
+ * them. */
+void shine_stream_close(shine_stream_t st);
+
+#endif
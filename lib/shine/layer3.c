@@ -74,7 +74,7 @@ int shine_check_config(int freq, int bitr) {
 }
 
 int shine_samples_per_pass(shine_t s) {
-  return s->mpeg.granules_per_frame * GRANULE_SIZE;
+  return SHINE_GRANULES(s) * GRANULE_SIZE;
 }
 
 /* Compute default encoding values. */
@@ -86,6 +86,21 @@ shine_global_config *shine_initialise(shine_config_t *pub_config) {
       0)
     return NULL;
 
+#ifdef SHINE_MONO_MPEG_I
+  /* Specialised build, see types.h */
+  if (pub_config->wave.channels != PCM_MONO ||
+      shine_check_config(pub_config->wave.samplerate, pub_config->mpeg.bitr) !=
+          MPEG_I)
+    return NULL;
+#endif
+
+  /* Arrays are sized by MAX_CHANNELS and MAX_GRANULES, see types.h */
+  if (pub_config->wave.channels > MAX_CHANNELS ||
+      granules_per_frame[shine_check_config(pub_config->wave.samplerate,
+                                            pub_config->mpeg.bitr)] >
+          MAX_GRANULES)
+    return NULL;
+
   config = calloc(1, sizeof(shine_global_config));
   if (config == NULL)
     return config;
@@ -159,7 +174,7 @@ static unsigned char *shine_encode_buffer_internal(shine_global_config *config,
   config->mpeg.bits_per_frame =
       8 * (config->mpeg.whole_slots_per_frame + config->mpeg.padding);
   config->mean_bits = (config->mpeg.bits_per_frame - config->sideinfo_len) /
-                      config->mpeg.granules_per_frame;
+                      SHINE_GRANULES(config);
 
   /* apply mdct to the polyphase output */
   shine_mdct_sub(config, stride);
@@ -170,8 +185,14 @@ static unsigned char *shine_encode_buffer_internal(shine_global_config *config,
   /* write the frame to the bitstream */
   shine_format_bitstream(config);
 
+  /* hand out the frame's tail too instead of keeping it for the next call */
+  if (config->low_latency)
+    shine_flush_bits(&config->bs);
+
   /* Return data. */
   *written = config->bs.data_position;
+  if (config->bs.data_position > config->bs.data_high_water)
+    config->bs.data_high_water = config->bs.data_position;
   config->bs.data_position = 0;
 
   return config->bs.data;
@@ -180,8 +201,10 @@ static unsigned char *shine_encode_buffer_internal(shine_global_config *config,
 unsigned char *shine_encode_buffer(shine_global_config *config, int16_t **data,
                                    int *written) {
   config->buffer[0] = data[0];
-  if (config->wave.channels == 2)
+#if MAX_CHANNELS > 1
+  if (SHINE_CHANNELS(config) == 2)
     config->buffer[1] = data[1];
+#endif
 
   return shine_encode_buffer_internal(config, written, 1);
 }
@@ -189,19 +212,61 @@ unsigned char *shine_encode_buffer(shine_global_config *config, int16_t **data,
 unsigned char *shine_encode_buffer_interleaved(shine_global_config *config,
                                                int16_t *data, int *written) {
   config->buffer[0] = data;
-  if (config->wave.channels == 2)
+#if MAX_CHANNELS > 1
+  if (SHINE_CHANNELS(config) == 2)
     config->buffer[1] = data + 1;
+#endif
 
-  return shine_encode_buffer_internal(config, written, config->wave.channels);
+  return shine_encode_buffer_internal(config, written, SHINE_CHANNELS(config));
 }
 
 unsigned char *shine_flush(shine_global_config *config, int *written) {
+  shine_flush_bits(&config->bs);
   *written = config->bs.data_position;
   config->bs.data_position = 0;
 
   return config->bs.data;
 }
 
+void shine_set_low_latency(shine_global_config *config, int enable) {
+  config->low_latency = enable;
+  if (enable) {
+    /* Empty reservoir: main data never starts in an earlier frame. */
+    config->ResvMax = 0;
+    config->ResvSize = 0;
+  }
+}
+
+void shine_last_frame_info(shine_global_config *config,
+                           shine_frame_info_t *info) {
+  int gr;
+
+  info->index = 0;
+  info->offset = 0;
+  info->bytes = config->mpeg.bits_per_frame / 8;
+  for (gr = 0; gr < 2; gr++)
+    info->energy[gr] = (SHINE_IS_MPEG_I(config) && gr < SHINE_GRANULES(config))
+                           ? config->l3loop.en_tot[gr]
+                           : 0;
+  info->peak = config->frame_xrmax;
+}
+
+void shine_get_footprint(shine_global_config *config,
+                         shine_footprint_t *footprint) {
+  footprint->loop_tables = sizeof(config->l3loop);
+  footprint->int2idx = sizeof(config->l3loop.int2idx);
+  footprint->subband = sizeof(config->subband);
+  footprint->mdct = sizeof(config->mdct);
+  footprint->samples = sizeof(config->l3_enc) + sizeof(config->l3_sb_sample) +
+                       sizeof(config->mdct_freq);
+  footprint->state = sizeof(shine_global_config) - footprint->loop_tables -
+                     footprint->subband - footprint->mdct - footprint->samples;
+  footprint->bitstream = config->bs.data_size;
+  footprint->bitstream_high_water = config->bs.data_high_water;
+  footprint->stream = 0;
+  footprint->total = sizeof(shine_global_config) + config->bs.data_size;
+}
+
 void shine_close(shine_global_config *config) {
   shine_close_bit_stream(&config->bs);
   free(config);
@@ -106,7 +106,8 @@ int shine_check_config(int freq, int bitr);
  * mode for wave and mpeg should also be consistent with each other.
  *
  * This function returns NULL if it was not able to allocate memory data for
- * the encoder. */
+ * the encoder, or if the library was built with SHINE_MONO_MPEG_I and the
+ * configuration is not mono MPEG-I. */
 shine_t shine_initialise(shine_config_t *config);
 
 /* Maximun possible value for the function below. */
@@ -135,10 +136,51 @@ unsigned char *shine_encode_buffer(shine_t s, int16_t **data, int *written);
 unsigned char *shine_encode_buffer_interleaved(shine_t s, int16_t *data,
                                                int *written);
 
+/* Low latency mode, for live streams that may be cut at any frame boundary.
+ * The bit reservoir is disabled so every frame is self-contained, and each
+ * call to `shine_encode_buffer` returns exactly the frame just encoded
+ * instead of holding back its last bytes until the next call. */
+void shine_set_low_latency(shine_t s, int enable);
+
 /* Flush all data currently in the encoding buffer. Should be used before
  * closing the encoder, to make all encoded data has been written. */
 unsigned char *shine_flush(shine_t s, int *written);
 
+/* Analysis values of the last encoded frame. They are by-products of the
+ * iteration loop, so reading them costs nothing extra. */
+typedef struct {
+  long index;        /* Frame number, filled in by the stream wrapper */
+  long offset;       /* Byte offset in the MP3 stream, idem */
+  int bytes;         /* Frame size in the MP3 stream */
+  int32_t energy[2]; /* Per granule energy (en_tot, log2 scale) of the first
+                        channel. MPEG-I only, 0 otherwise */
+  int32_t peak;      /* Largest absolute MDCT value (xrmax) in the frame */
+} shine_frame_info_t;
+
+/* Fill in `info` for the frame returned by the last call to
+ * `shine_encode_buffer` or `shine_encode_buffer_interleaved`. `index` and
+ * `offset` are left at 0, the encoder does not track stream positions. */
+void shine_last_frame_info(shine_t s, shine_frame_info_t *info);
+
+/* Memory held by one encoder, in bytes. */
+typedef struct {
+  int total;       /* Everything below */
+  int state;       /* Handle, excluding the tables and arrays below */
+  int loop_tables; /* Iteration loop tables, int2idx included */
+  int int2idx;     /* x**(3/4) lookup table, part of loop_tables */
+  int subband;     /* Analysis filterbank coefficients and history */
+  int mdct;        /* MDCT coefficients */
+  int samples;     /* Subband, MDCT and quantized sample arrays */
+  int bitstream;   /* Output buffer, grows when a frame does not fit */
+  int bitstream_high_water; /* Most output data held at once so far */
+  int stream; /* l3stream wrapper with its PCM accumulator, 0 for a bare
+                 encoder, see `shine_stream_get_footprint` */
+} shine_footprint_t;
+
+/* Fill in `footprint` with the memory currently used by the encoder. Array
+ * sizes depend on the MAX_CHANNELS and MAX_GRANULES build options. */
+void shine_get_footprint(shine_t s, shine_footprint_t *footprint);
+
 /* Close an encoder, freeing all associated memory. Encoder handler is not
  * valid after this call. */
 void shine_close(shine_t s);
@@ -21,7 +21,7 @@ int shine_max_reservoir_bits(double *pe, shine_global_config *config) {
   int more_bits, max_bits, add_bits, over_bits;
   int mean_bits = config->mean_bits;
 
-  mean_bits /= config->wave.channels;
+  mean_bits /= SHINE_CHANNELS(config);
   max_bits = mean_bits;
 
   if (max_bits > 4095)
@@ -57,7 +57,7 @@ int shine_max_reservoir_bits(double *pe, shine_global_config *config) {
  */
 void shine_ResvAdjust(gr_info *gi, shine_global_config *config) {
   config->ResvSize +=
-      (config->mean_bits / config->wave.channels) - gi->part2_3_length;
+      (config->mean_bits / SHINE_CHANNELS(config)) - gi->part2_3_length;
 }
 
 /*
@@ -78,7 +78,7 @@ void shine_ResvFrameEnd(shine_global_config *config) {
   ancillary_pad = 0;
 
   /* just in case mean_bits is odd, this is necessary... */
-  if ((config->wave.channels == 2) && (config->mean_bits & 1))
+  if ((SHINE_CHANNELS(config) == 2) && (config->mean_bits & 1))
     config->ResvSize += 1;
 
   over_bits = config->ResvSize - config->ResvMax;
@@ -106,8 +106,8 @@ void shine_ResvFrameEnd(shine_global_config *config) {
       gi->part2_3_length += stuffingBits;
     else {
       /* plan b: distribute throughout the granules */
-      for (gr = 0; gr < config->mpeg.granules_per_frame; gr++)
-        for (ch = 0; ch < config->wave.channels; ch++) {
+      for (gr = 0; gr < SHINE_GRANULES(config); gr++)
+        for (ch = 0; ch < SHINE_CHANNELS(config); ch++) {
           int extraBits, bitsThisGr;
           gr_info *gi = (gr_info *)&(l3_side->gr[gr].ch[ch]);
           if (!stuffingBits)
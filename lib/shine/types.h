@@ -51,14 +51,41 @@
 #define SCALE 32768
 #define SBLIMIT 32
 
+/* MAX_CHANNELS and MAX_GRANULES size the per channel/granule arrays in
+ * shine_global_config. They can be lowered from the build flags: a mono build
+ * only needs MAX_CHANNELS 1, and an MPEG-II/2.5 only build (one granule per
+ * frame) only needs MAX_GRANULES 1. shine_initialise() refuses configurations
+ * that do not fit. */
 #ifndef MAX_CHANNELS
+#ifdef SHINE_MONO_MPEG_I
+#define MAX_CHANNELS 1
+#else
 #define MAX_CHANNELS 2
 #endif
+#endif
 
 #ifndef MAX_GRANULES
 #define MAX_GRANULES 2
 #endif
 
+/* Compile-time specialisation.
+ *
+ * Define SHINE_MONO_MPEG_I to build an encoder restricted to mono MPEG-I
+ * (32, 44.1 and 48 kHz). The channel and granule counts then become
+ * constants, letting the compiler unroll the per channel/granule loops and
+ * drop the MPEG-II/2.5 branches. shine_initialise() refuses any other
+ * configuration in that build. Without the define the generic runtime path
+ * is used. */
+#ifdef SHINE_MONO_MPEG_I
+#define SHINE_CHANNELS(config) 1
+#define SHINE_GRANULES(config) 2
+#define SHINE_IS_MPEG_I(config) 1
+#else
+#define SHINE_CHANNELS(config) ((config)->wave.channels)
+#define SHINE_GRANULES(config) ((config)->mpeg.granules_per_frame)
+#define SHINE_IS_MPEG_I(config) ((config)->mpeg.version == MPEG_I)
+#endif
+
 typedef struct {
   int channels;
   int samplerate;
@@ -172,6 +199,8 @@ typedef struct shine_global_flags {
   int32_t mdct_freq[MAX_CHANNELS][MAX_GRANULES][GRANULE_SIZE];
   int ResvSize;
   int ResvMax;
+  int32_t frame_xrmax; /* largest xrmax of the last frame, any gr/ch */
+  int low_latency;     /* no reservoir, one whole frame per encode call */
   l3loop_t l3loop;
   mdct_t mdct;
   subband_t subband;
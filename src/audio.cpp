@@ -2,34 +2,50 @@
 
 #include "config.h"
 #include "audio.h"
-#include "network.h" // getCurrentDateTime(), uploadSensorData() 호출을 위해 포함
+#include "capture.h" // I2S 캡처 링 버퍼
+
+#include "mp3_encoder.h" // Shine MP3 스트림 인코더 래퍼
+#include "frame_index.h" // 프레임 인덱스 사이드카
+#include "band_levels.h" // A 가중/짖음 대역 연속 소음 측정
+#include "classifier.h"  // 트리거 후 소리 분류
+#include "events.h"      // 트리거 큐 및 녹음 병합
+#include "spool.h"       // 녹음 클립 저장 후 전송
+#include "live.h"        // 실시간 스트리밍
+#include "telemetry.h"   // 녹음 시점 센서 값
+#include "sensors.h"     // 센서 스냅샷
+#include "metrics.h"
 
-// Shine MP3 인코더 라이브러리 (C언어) 포함
-extern "C" {
-  #include "layer3.h"
-}
-
-unsigned long last_sound_check = 0;
 int consecutive_high_count = 0;
 
-// 새로운 실시간 녹음 및 업로드 함수
-void realtimeRecordAndUpload();
+// 소음 감지는 캡처 링의 모든 샘플을 sound_check_interval 길이의 구간으로 나눠 빠짐없이 측정
+static const uint32_t SOUND_WINDOW_SAMPLES = SAMPLE_RATE * sound_check_interval / 1000;
+static CaptureReader soundReader;
+static BandLevels soundLevels;
+static BandLevels recordLevels; // 녹음 중 이벤트가 끝났는지 판단 (인코딩하는 구간과 같은 샘플)
+
+static QueueHandle_t i2sEventQueue = NULL; // DMA 버퍼 완료(RX_DONE) 이벤트, 캡처 Task가 수신
+
+// 녹음하여 스풀에 저장하는 함수 (업로드는 업로드 Task가 담당)
+void recordToSpool(RecordingEvent& event);
 
 // 오디오 Task 함수
 void audio_task_function(void *pvParameters) {
   for (;;) {
-    // 세마포를 받을 때까지 무한정 대기
-    if (xSemaphoreTake(audioSemaphore, portMAX_DELAY) == pdTRUE) {
-      D_PRINTLN("[Audio Task] 세마포 수신. 실시간 녹음 및 업로드 시작.");
-      deviceState.isRecording = true;
+    // 트리거를 받을 때까지 무한정 대기
+    Trigger trigger;
+    if (waitTrigger(trigger, portMAX_DELAY)) {
+      // 녹음 직후 큐에 남아 있던 트리거가 이미 녹음된 구간이면 새 녹음을 만들지 않음
+      if (recordedUntil() != 0 && (int32_t)(recordedUntil() - trigger.seq) >= 0) {
+        D_PRINTLN("[Audio Task] 이미 녹음된 구간의 트리거, 건너뜀.");
+        continue;
+      }
 
-      realtimeRecordAndUpload(); // 새로운 실시간 함수 호출
+      D_PRINTLN("[Audio Task] 트리거 수신. 녹음 시작.");
+      deviceState.isRecording = true;
 
-      // 녹음 후 현재 센서 데이터도 함께 전송
-      float temp = dht.getTemperature();
-      float humi = dht.getHumidity();
-      float co2 = MQ135.readSensor();
-      uploadSensorData(temp, humi, co2 + 400);
+      RecordingEvent event;
+      event.add(trigger);
+      recordToSpool(event); // 녹음 중 들어온 트리거는 이 녹음에 합쳐짐
 
       deviceState.isRecording = false;
       D_PRINTLN("[Audio Task] 작업 완료.");
@@ -45,13 +61,13 @@ void initI2S() {
       .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
       .communication_format = I2S_COMM_FORMAT_STAND_I2S,
       .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-      .dma_buf_count = 8,
-      .dma_buf_len = 1024,
+      .dma_buf_count = CAPTURE_DMA_BUFFERS,
+      .dma_buf_len = CAPTURE_BLOCK_SAMPLES,
       .use_apll = false,
       .tx_desc_auto_clear = false,
       .fixed_mclk = 0
   };
-  i2s_driver_install(I2S_PORT, &i2s_config, 0, NULL);
+  i2s_driver_install(I2S_PORT, &i2s_config, CAPTURE_DMA_BUFFERS, &i2sEventQueue);
 
   const i2s_pin_config_t pin_config = {
       .bck_io_num = I2S_SCK_PIN,
@@ -67,187 +83,236 @@ void setupAudio() {
   initI2S();
   i2s_start(I2S_PORT); // 소음 감지를 위해 I2S를 계속 켜 둡니다.
   D_PRINTLN("실시간 오디오 처리를 위해 I2S 초기화 완료.");
+
+  // I2S는 캡처 Task만 읽고, 소음 감지와 녹음은 캡처 링 버퍼에서 읽음
+  // 녹음 클립 저장소와 업로드 Task. 실패해도 소음 측정과 /live는 계속 동작하고 녹음만 건너뜀
+  if (!setupSpool()) {
+    D_PRINTLN("스풀을 사용할 수 없어 녹음은 저장하지 않습니다.");
+  }
+
+  if (setupCapture(i2sEventQueue)) {
+    captureReaderBegin(soundReader, captureHead());
+    setupLive(); // GET /live 스트리밍도 같은 캡처 링을 사용
+  }
+  soundLevels.begin(SOUND_WINDOW_SAMPLES, SAMPLE_RATE, BARK_BAND_LOW_HZ, BARK_BAND_HIGH_HZ);
+  recordLevels.begin(SOUND_WINDOW_SAMPLES, SAMPLE_RATE, BARK_BAND_LOW_HZ, BARK_BAND_HIGH_HZ);
+  setupClassifier();
 }
 
-void handleSoundCheck() {
-  if (millis() - last_sound_check >= sound_check_interval) {
-    last_sound_check = millis();
-    
-    if (deviceState.isRecording) return; // 녹음 중일 때는 소음 감지 안 함
-
-    int16_t samples[DB_CHECK_BUFFER_SIZE];
-    size_t bytes_read;
-    i2s_read(I2S_PORT, &samples, sizeof(samples), &bytes_read, pdMS_TO_TICKS(100));
-
-    if (bytes_read > 0) {
-      double sum_squares = 0;
-      int sample_count = bytes_read / sizeof(int16_t);
-      for (int i = 0; i < sample_count; i++) {
-        sum_squares += pow(samples[i] / 32768.0f, 2);
-      }
-      float rms = sqrt(sum_squares / sample_count);
-      float db_spl = (rms > 0) ? (94.0f + 20.0f * log10(rms / REFERENCE_RMS)) : 0;
-      D_PRINTF("현재 소음 -> RMS: %.6f | dB: %.2f\n", rms, db_spl);
-
-      if (digitalRead(PIR_PIN) == HIGH && db_spl > SOUND_DETECT_DB) {
-        consecutive_high_count++;
-      } else {
-        consecutive_high_count = 0;
-      }
+// 완성된 측정 구간 하나의 레벨 판정. windowEnd는 구간이 끝난 캡처 순번
+// 광대역 레벨 대신 짖음 대역 레벨과 그 비중으로 판정해, 저주파 위주인 팬/히터 소음으로는 녹음하지 않음
+static void evaluateSoundWindow(uint32_t windowEnd) {
+  float db_spl = soundLevels.barkDb();
+  float share = soundLevels.barkShareDb();
+  D_PRINTF("현재 소음 -> dB: %.2f | dBA: %.2f | 짖음 대역: %.2f (%.1f dB) | LAeq(%ds): %.2f\n",
+           soundLevels.broadDb(), soundLevels.aWeightedDb(), db_spl, share,
+           LevelMeter::LONG_WINDOWS * (int)sound_check_interval / 1000, soundLevels.longDb());
+
+  if (digitalRead(PIR_PIN) == HIGH && db_spl > SOUND_DETECT_DB && share > BARK_MIN_SHARE_DB) {
+    consecutive_high_count++;
+  } else {
+    consecutive_high_count = 0;
+  }
 
-      if (consecutive_high_count >= REQUIRED_CONSECUTIVE_HITS) {
-        D_PRINTF("\n!!! %.1f dB 이상의 지속적인 소음 감지 (%.2f dB) !!!\n", SOUND_DETECT_DB, db_spl);
-        consecutive_high_count = 0;
-        
-        xSemaphoreGive(audioSemaphore);
-      }
+  if (consecutive_high_count >= REQUIRED_CONSECUTIVE_HITS) {
+    D_PRINTF("\n!!! %.1f dB 이상의 지속적인 소음 감지 (%.2f dB) !!!\n", SOUND_DETECT_DB, db_spl);
+    consecutive_high_count = 0;
+
+    // 짖음/낑낑거림으로 분류된 경우에만 인코딩 및 업로드 (녹음 중이면 진행 중인 녹음을 연장)
+    // loop()가 늦게 돌아 밀린 구간을 한꺼번에 판정해도 트리거 위치는 판정한 구간 기준
+    ClassifierResult result;
+    if (classifyTrigger(false, windowEnd, result)) {
+      postTrigger(TRIGGER_SOUND, windowEnd, result);
+    } else {
+      D_PRINTLN("기타 소리로 분류되어 녹음을 생략합니다.");
     }
   }
 }
 
-void realtimeRecordAndUpload() {
-    D_PRINTLN("\n--- 실시간 MP3 인코딩 및 업로드 시작 ---");
-
-    // 1. Shine MP3 인코더 초기화
-    shine_config_t config;
-    shine_set_config_mpeg_defaults(&config.mpeg);
-    config.wave.samplerate = SAMPLE_RATE;
-    config.wave.channels = PCM_MONO;
-    config.mpeg.bitr = MP3_BITRATE;
-    config.mpeg.mode = MONO;
-    
-    if (shine_check_config(config.wave.samplerate, config.mpeg.bitr) < 0) {
-        D_PRINTLN("지원되지 않는 샘플레이트/비트레이트 설정입니다.");
-        return;
-    }
-    shine_t s = shine_initialise(&config);
-    if (!s) {
-        D_PRINTLN("Shine 인코더 초기화 실패.");
-        return;
+// 녹음 중에도 계속 측정. 이때 발생한 트리거는 진행 중인 녹음에 합쳐짐
+void handleSoundCheck() {
+  // 지난 호출 이후 캡처된 샘플을 모두 복사 없이 읽음
+  const int16_t* samples;
+  size_t n;
+  while ((n = captureAcquire(soundReader, &samples, SOUND_WINDOW_SAMPLES)) > 0) {
+    // 측정 구간 경계에서 끊어 먹이고, 구간이 끝날 때만 dB로 변환해 판정
+    size_t used = soundLevels.feed(samples, n);
+    captureRelease(soundReader, used);
+    if (soundLevels.windowReady()) {
+      evaluateSoundWindow(soundReader.seq);
     }
+  }
+}
 
-    // 2. 네트워크 클라이언트 연결
-    WiFiClient client;
-    if (!client.connect(upload_server, upload_port)) {
-        D_PRINTLN("서버 연결 실패!");
-        shine_close(s);
+// 인코더 메모리 사용량 출력. 내부 SRAM에 올릴 수 있는지 판단하는 기준
+static void reportEncoderFootprint(const Mp3Encoder& encoder) {
+  shine_footprint_t fp;
+  if (!encoder.footprint(&fp)) return;
+
+  D_PRINTF("Shine 메모리: 총 %d B (상태 %d, 루프 테이블 %d [int2idx %d], 서브밴드 %d, MDCT %d, 샘플 배열 %d, 비트스트림 %d / 최대 사용 %d, 스트림 버퍼 %d)\n",
+           fp.total, fp.state, fp.loop_tables, fp.int2idx, fp.subband, fp.mdct,
+           fp.samples, fp.bitstream, fp.bitstream_high_water, fp.stream);
+#ifdef SHINE_RAM_BUDGET
+  if (fp.total > SHINE_RAM_BUDGET) {
+    D_PRINTF("경고: Shine 메모리가 예산(%d B)을 초과했습니다.\n", SHINE_RAM_BUDGET);
+  }
+#endif
+}
+
+static Counter recordFrames("pet_mp3_frames_total", "MP3 frames encoded", "enc=\"record\"");
+static Histogram recordMs("pet_record_ms", "Recording time in milliseconds (capture, encode and spool write)", nullptr,
+                          DURATION_MS_BOUNDS, DURATION_MS_BOUNDS_COUNT);
+static Gauge encodeSpeed("pet_record_encode_speed_x100", "Encoded audio seconds per wall-clock second of the last recording, x100");
+
+void recordToSpool(RecordingEvent& event) {
+    D_PRINTLN("\n--- MP3 인코딩 및 스풀 저장 시작 ---");
+    unsigned long started = millis();
+
+    // 1. 스풀 클립 생성. 네트워크 연결 없이 녹음하고, 업로드는 업로드 Task가 따로 처리
+    SpoolClip clip;
+    if (!clip.begin()) {
+        D_PRINTLN("스풀 클립을 만들 수 없어 녹음을 중단합니다.");
         return;
     }
-    D_PRINTLN("서버 연결 성공.");
-
-    // 3. HTTP 헤더 전송 (Chunked-Encoding은 서버 지원이 필요하므로, 예상 길이를 보내는 방식으로 우선 구현)
-    // 예상 MP3 크기 계산 (정확하지 않을 수 있음, 헤더 전송을 위해 대략적으로 계산)
-    // (샘플레이트 * 시간 * 비트레이트) / 8 / 압축률(대략 11)
-    uint32_t estimated_mp3_size = (SAMPLE_RATE * RECORD_SECONDS * MP3_BITRATE) / 8 / 11;
-
-    String boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
-    String dateTime = getCurrentDateTime();
-    String filename = String(device_id) + dateTime + ".mp3";
-
-    String head;
-    head += "--" + boundary + "\r\n";
-    head += "Content-Disposition: form-data; name=\"i\"\r\n\r\n" + String(device_id) + "\r\n";
-    head += "--" + boundary + "\r\n";
-    head += "Content-Disposition: form-data; name=\"d\"\r\n\r\n" + dateTime + "\r\n";
-    head += "--" + boundary + "\r\n";
-    head += "Content-Disposition: form-data; name=\"awfile\"; filename=\"" + filename + "\"\r\n";
-    head += "Content-Type: audio/mpeg\r\n\r\n";
-    String tail = "\r\n--" + boundary + "--\r\n";
-    
-    // Content-Length를 지금 알 수 없으므로, 스트리밍을 위해 헤더를 나중에 보내거나 Chunked-Encoding을 사용해야 함.
-    // 여기서는 먼저 연결하고, 데이터를 모은 뒤 길이를 계산해서 보내는 방식을 유지하되, 메모리 버퍼 대신 직접 전송 로직으로 변경.
-    // 하지만 HTTP/1.1은 Content-Length 없이 Chunked transfer를 지원하지만, 구현이 복잡해짐.
-    // 여기서는 우선 MP3 데이터를 임시 버퍼에 모았다가 한번에 보내는 방식으로 다시 구현합니다.
-    // 실시간 스트리밍의 진정한 이점을 얻으려면 서버 측에서 스트림을 직접 받을 수 있어야 합니다.
-    
-    uint8_t* mp3_buffer = (uint8_t*)malloc(MP3_BUFFER_SIZE);
-    if (!mp3_buffer) {
-        D_PRINTLN("MP3 버퍼를 위한 메모리 할당 실패.");
-        client.stop();
-        shine_close(s);
+
+    // 2. Shine MP3 인코더 초기화. 인코딩된 프레임은 완성되는 즉시 스풀 파일에 기록됨
+    Mp3Encoder encoder;
+    bool encoderReady = encoder.begin(SAMPLE_RATE, MP3_BITRATE, [&](const uint8_t* data, size_t len) {
+        clip.write(data, len);
+    });
+    if (!encoderReady) {
+        D_PRINTLN("Shine 인코더 초기화 실패 (설정 또는 메모리 문제).");
         return;
     }
 
-    int samples_per_pass = shine_samples_per_pass(s);
-    int16_t pcm_buffer[samples_per_pass];
+    // 트리거 이전 PREROLL_MS 구간부터 인코딩. 캡처 링의 데이터를 복사 없이 바로 인코더에 넘김
+    // 녹음 길이는 소리에 따라 정해짐: 최소 RECORD_MIN_SECONDS, 조용한 상태가 RECORD_HANGOVER_MS 이어지면 종료,
+    // 소리가 계속되면 RECORD_MAX_SECONDS까지 연장 (모두 트리거 시점 기준)
+    // 큐에서 기다린 트리거일 수 있으므로 기준은 트리거 시점의 순번. 프리롤은 이전 녹음과 겹치지 않게 자름
+    CaptureReader reader;
+    uint32_t trigger_seq = captureClamp(event.first.seq);
+    uint32_t start_seq = captureClamp(trigger_seq - (uint32_t)SAMPLE_RATE * PREROLL_MS / 1000);
+    if (recordedUntil() != 0 && (int32_t)(recordedUntil() - start_seq) > 0) {
+        start_seq = captureClamp(recordedUntil());
+    }
+    captureReaderBegin(reader, start_seq);
+    const uint32_t min_samples = SAMPLE_RATE * RECORD_MIN_SECONDS;
+    const uint32_t max_samples = SAMPLE_RATE * RECORD_MAX_SECONDS;
+    const uint32_t hangover_samples = (uint32_t)SAMPLE_RATE * RECORD_HANGOVER_MS / 1000;
+    // 녹음 중 들어온 트리거마다 끝을 연장하되, 첫 트리거 기준 RECORD_MERGE_MAX_SECONDS를 넘지 않음
+    const uint32_t hard_end_seq = trigger_seq + SAMPLE_RATE * RECORD_MERGE_MAX_SECONDS;
+    uint32_t end_seq = trigger_seq + max_samples;
+    uint32_t last_loud_seq = trigger_seq;
     size_t total_samples_read = 0;
-    size_t total_samples_to_read = SAMPLE_RATE * RECORD_SECONDS;
-    int mp3_bytes_written = 0;
-
-    D_PRINTF("%d초 동안 녹음 및 인코딩 진행...\n", RECORD_SECONDS);
-
-    while (total_samples_read < total_samples_to_read) {
-        size_t bytes_read = 0;
-        i2s_read(I2S_PORT, (char*)pcm_buffer, sizeof(pcm_buffer), &bytes_read, portMAX_DELAY);
-
-        if (bytes_read > 0) {
-            int samples_read = bytes_read / sizeof(int16_t);
-            total_samples_read += samples_read;
-
-            unsigned char *data;
-            int len;
-            int16_t* pcm_ptr = pcm_buffer;
-            data = shine_encode_buffer(s, &pcm_ptr, &len);
-
-            if (len > 0) {
-                if (mp3_bytes_written + len > MP3_BUFFER_SIZE) {
-                    D_PRINTLN("MP3 버퍼 오버플로우!");
-                    break;
-                }
-                memcpy(mp3_buffer + mp3_bytes_written, data, len);
-                mp3_bytes_written += len;
-            }
-        }
+    recordLevels.reset();
+
+    // 프레임 인덱스는 인코더가 이미 계산한 값을 받아 적기만 함 (PCM 추가 순회 없음)
+    FrameIndex frameIndex;
+    size_t max_frames = (hard_end_seq - start_seq) / encoder.samplesPerFrame() + 1;
+    if (frameIndex.begin(max_frames, encoder.samplesPerFrame())) {
+        encoder.onFrame([&](const shine_frame_info_t& info) { frameIndex.add(info); });
+    } else {
+        D_PRINTLN("프레임 인덱스 메모리 할당 실패, 인덱스 없이 진행.");
     }
 
-    // 마지막 남은 데이터 플러시
-    unsigned char *flushed_data;
-    int flushed_len;
-    flushed_data = shine_flush(s, &flushed_len);
-    if (flushed_len > 0) {
-        if (mp3_bytes_written + flushed_len <= MP3_BUFFER_SIZE) {
-            memcpy(mp3_buffer + mp3_bytes_written, flushed_data, flushed_len);
-            mp3_bytes_written += flushed_len;
+    D_PRINTF("프리롤 %dms + %d~%d초 동안 녹음 및 인코딩 진행...\n", PREROLL_MS, RECORD_MIN_SECONDS, RECORD_MAX_SECONDS);
+
+    uint32_t overruns_before = captureOverruns();
+    while (!clip.failed()) {
+        // 녹음 중 들어온 트리거를 합쳐 녹음을 연장 (새 클립/인코딩을 만들지 않음)
+        uint32_t merged_seq;
+        if (mergePendingTriggers(event, merged_seq)) {
+            if ((int32_t)(merged_seq - last_loud_seq) > 0) last_loud_seq = merged_seq;
+            uint32_t extended = merged_seq + max_samples;
+            if ((int32_t)(extended - hard_end_seq) > 0) extended = hard_end_seq;
+            if ((int32_t)(extended - end_seq) > 0) end_seq = extended;
+        }
+
+        // 트리거 이후 경과 샘플 수 (프리롤 구간에서는 음수)
+        int32_t elapsed = (int32_t)(reader.seq - trigger_seq);
+        int32_t remaining = (int32_t)(end_seq - reader.seq);
+        if (remaining <= 0) break;
+        if (elapsed >= (int32_t)min_samples && (int32_t)(reader.seq - last_loud_seq) >= (int32_t)hangover_samples) break;
+
+        // 인코딩이 밀려 캡처가 앞지른 구간은 captureAcquire가 건너뛰고 reader.dropped에 기록
+        // 오래된 위치(큐에서 기다린 트리거)는 캡처 Task와의 여유가 블록 2개뿐이므로 한 번에 한 블록씩만 읽음
+        const int16_t* pcm;
+        size_t n = captureAcquire(reader, &pcm, min((size_t)remaining, (size_t)CAPTURE_BLOCK_SAMPLES));
+        if (n == 0) {
+            captureWait(reader, pdMS_TO_TICKS(100)); // 캡처 Task가 다음 블록을 공개할 때까지 대기
+            continue;
         }
+
+        // 캡처된 만큼 그대로 인코더에 넘김 (프레임 크기와 맞출 필요 없음)
+        encoder.write(pcm, n);
+
+        // 같은 구간으로 짖음 대역 레벨을 측정해, 시끄러운 구간이 끝난 위치를 기록
+        for (size_t used = 0; used < n; ) {
+            used += recordLevels.feed(pcm + used, n - used);
+            if (recordLevels.windowReady() && recordLevels.barkDb() > RECORD_QUIET_DB) {
+                last_loud_seq = reader.seq + used;
+            }
+        }
+
+        // 인코딩/레벨 측정 중 캡처 Task가 이 구간을 덮어썼다면 reader.dropped에 기록됨
+        captureRelease(reader, n);
+        total_samples_read += n;
     }
-    
-    D_PRINTF("인코딩 완료. 총 MP3 크기: %d bytes\n", mp3_bytes_written);
-
-    // 이제 전체 크기를 알았으므로 헤더와 함께 전송
-    uint32_t contentLength = head.length() + mp3_bytes_written + tail.length();
-
-    client.println("POST " + String(upload_file_path) + " HTTP/1.1");
-    client.println("Host: " + String(upload_server));
-    client.println("Connection: close");
-    client.println("Content-Type: multipart/form-data; boundary=" + boundary);
-    client.println("Content-Length: " + String(contentLength));
-    client.println();
-
-    D_PRINTLN("페이로드 전송 중...");
-    client.print(head);
-    client.write((const byte*)mp3_buffer, mp3_bytes_written);
-    client.print(tail);
-    D_PRINTLN("페이로드 전송 완료.");
-
-    // 서버 응답 대기 및 출력
-    unsigned long timeout = millis();
-    while (!client.available() && millis() - timeout < 5000) { delay(10); }
-    D_PRINTLN("--- 서버 응답 ---");
-    while(client.available()){
-      String line = client.readStringUntil('\n');
-      D_PRINTLN(line);
+    markRecordedUntil(reader.seq);
+    D_PRINTF("녹음 길이: %.1f초 (프리롤 포함), 트리거 %d개 병합\n", (float)total_samples_read / SAMPLE_RATE, event.triggers);
+    if (reader.dropped > 0 || captureOverruns() != overruns_before) {
+        D_PRINTF("캡처 링 오버런: 인코딩 지연으로 %u 샘플 건너뜀/손상, DMA 오버플로 %u회\n",
+                 (unsigned)reader.dropped, (unsigned)(captureOverruns() - overruns_before));
     }
-    D_PRINTLN("-----------------");
 
-    // 리소스 정리
-    free(mp3_buffer);
-    client.stop();
-    shine_close(s);
-    D_PRINTLN("업로드 과정 종료.");
+    // 마지막 미완성 프레임을 채워서 인코딩하고 남은 데이터 플러시
+    encoder.finish();
+    int samples_per_frame = encoder.samplesPerFrame();
+    reportEncoderFootprint(encoder);
+    encoder.end();
+
+    unsigned long elapsedMs = millis() - started;
+    recordFrames.inc((total_samples_read + samples_per_frame - 1) / samples_per_frame);
+    recordMs.observe(elapsedMs);
+    if (elapsedMs > 0) encodeSpeed.set((int32_t)((uint64_t)total_samples_read * 100000 / SAMPLE_RATE / elapsedMs));
+
+    if (clip.failed()) {
+        D_PRINTLN("스풀 기록 실패로 녹음을 버립니다.");
+        return;
+    }
+
+    // 3. 업로드에 필요한 메타데이터: 녹음 시각, 분류 결과, 합쳐진 트리거
+    const ClassifierResult& cls = event.first.cls;
+    JsonDocument meta;
+    meta["ts"] = (long)time(NULL);
+    JsonObject c = meta["cls"].to<JsonObject>();
+    c["c"] = soundClassName(cls.cls);
+    c["fc"] = cls.forced;
+    c["ct"] = (int)cls.features.centroidHz;
+    c["fl"] = serialized(String(cls.features.flatness, 3));
+    c["bs"] = serialized(String(cls.features.barkShare, 3));
+    c["ps"] = serialized(String(cls.features.peakShare, 3));
+    eventMetadata(event, start_seq, meta["ev"].to<JsonObject>());
+    String metaJson;
+    serializeJson(meta, metaJson);
+
+    // 4. 프레임 인덱스와 메타데이터를 기록하고 업로드 대기열에 올림
+    clip.commit(frameIndex.data(), frameIndex.size(), metaJson);
+    D_PRINTF("저장 완료. MP3 %u bytes, 인덱스 %u 프레임\n", (unsigned)clip.bytes(), (unsigned)frameIndex.frames());
+
+    // 5. 녹음 직후 센서 값은 모아 둔 샘플과 함께 바로 전송 (녹음 업로드와는 별도)
+    SensorSnapshot sensors = sensorSnapshot();
+    if (sensorSnapshotFresh(sensors, SENSOR_STALE_MS)) {
+        telemetryAdd(sensors.temp, sensors.humi, sensors.co2);
+    }
+    telemetryFlush();
 }
 
 // Nextion 버튼으로 녹음 및 업로드 강제 실행
 void forceRecordAndUpload() {
   D_PRINTLN("Nextion 요청: 녹음 및 업로드 신호 전송");
-  xSemaphoreGive(audioSemaphore);
+  uint32_t seq = captureHead();
+  ClassifierResult result;
+  classifyTrigger(true, seq, result); // 분류 결과는 기록만 하고 항상 녹음
+  postTrigger(TRIGGER_FORCED, seq, result);
 }
\ No newline at end of file
@@ -4,6 +4,5 @@
 void setupAudio();
 void handleSoundCheck();
 void forceRecordAndUpload();
-void realtimeRecordAndUpload(); // 기존 recordAudio를 대체할 새로운 함수
 
 #endif
\ No newline at end of file
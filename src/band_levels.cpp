@@ -0,0 +1,39 @@
+// band_levels.cpp
+
+#include "band_levels.h"
+#include <math.h>
+
+void BandLevels::begin(uint32_t windowSamples, float sampleRate, float barkLowHz, float barkHighHz) {
+  designAWeighting(aFilter, sampleRate);
+  designBandpass(barkFilter, barkLowHz, barkHighHz, sampleRate);
+  broadband.begin(windowSamples);
+  aWeighted.begin(windowSamples);
+  bark.begin(windowSamples);
+}
+
+void BandLevels::reset() {
+  aFilter.reset();
+  barkFilter.reset();
+  broadband.reset();
+  aWeighted.reset();
+  bark.reset();
+}
+
+size_t BandLevels::feed(const int16_t* pcm, size_t n) {
+  if (n > CHUNK) n = CHUNK;
+  size_t used = broadband.feed(pcm, n);
+
+  // 광대역 측정기가 구간 경계에서 끊은 만큼만 필터링해 나머지 측정기에 넣음
+  aFilter.process(pcm, scratch, used);
+  aWeighted.feed(scratch, used);
+  barkFilter.process(pcm, scratch, used);
+  bark.feed(scratch, used);
+  return used;
+}
+
+float BandLevels::barkShareDb() const {
+  uint64_t total = aWeighted.shortEnergy();
+  uint64_t band = bark.shortEnergy();
+  if (total == 0 || band == 0) return -100.0f;
+  return 10.0f * log10f((float)band / (float)total);
+}
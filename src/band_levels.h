@@ -0,0 +1,39 @@
+// band_levels.h
+
+#ifndef BAND_LEVELS_H
+#define BAND_LEVELS_H
+
+#include "biquad.h"
+#include "level_meter.h"
+
+// 대역별 소음 측정: 광대역(무가중), A 가중, 짖음 대역(BARK_BAND_LOW_HZ ~ BARK_BAND_HIGH_HZ)
+// 세 측정기는 같은 샘플을 같은 구간 경계로 받으므로 windowReady()가 항상 함께 바뀝니다.
+class BandLevels {
+public:
+  void begin(uint32_t windowSamples, float sampleRate, float barkLowHz, float barkHighHz);
+  void reset();
+
+  // LevelMeter::feed()와 같은 규칙: 구간 끝까지만 소비하고 소비한 개수를 반환
+  size_t feed(const int16_t* pcm, size_t n);
+  bool windowReady() const { return broadband.windowReady(); }
+
+  float broadDb() const { return broadband.shortDb(); }
+  float aWeightedDb() const { return aWeighted.shortDb(); }
+  float barkDb() const { return bark.shortDb(); }
+  float longDb() const { return aWeighted.longDb(); } // A 가중 장기 Leq
+
+  // 짖음 대역 에너지와 A 가중 전체 에너지의 비 (dB). 0 근처면 에너지 대부분이 짖음 대역에 있음
+  float barkShareDb() const;
+
+private:
+  static const size_t CHUNK = 256; // 필터 출력 임시 버퍼 (static, 스택 사용 없음)
+
+  FilterChain aFilter;
+  FilterChain barkFilter;
+  LevelMeter broadband;
+  LevelMeter aWeighted;
+  LevelMeter bark;
+  int16_t scratch[CHUNK];
+};
+
+#endif
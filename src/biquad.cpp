@@ -0,0 +1,153 @@
+// biquad.cpp
+
+#include "biquad.h"
+#include <math.h>
+
+static int32_t toFixed(float v) {
+  return (int32_t)lrintf(v * (float)(1L << Biquad::COEFF_BITS));
+}
+
+void Biquad::set(const BiquadCoeffs& c) {
+  b0 = toFixed(c.b0);
+  b1 = toFixed(c.b1);
+  b2 = toFixed(c.b2);
+  a1 = toFixed(c.a1);
+  a2 = toFixed(c.a2);
+  reset();
+}
+
+void Biquad::reset() {
+  x1 = x2 = y1 = y2 = 0;
+  err = 0;
+}
+
+int32_t Biquad::process(int32_t x) {
+  int64_t acc = err;
+  acc += (int64_t)b0 * x + (int64_t)b1 * x1 + (int64_t)b2 * x2;
+  acc -= (int64_t)a1 * y1 + (int64_t)a2 * y2;
+
+  int32_t y = (int32_t)(acc >> COEFF_BITS);
+  err = acc - ((int64_t)y << COEFF_BITS);
+
+  x2 = x1;
+  x1 = x;
+  y2 = y1;
+  y1 = y;
+  return y;
+}
+
+BiquadCoeffs Biquad::bilinear(float b2, float b1, float b0, float a2, float a1, float a0, float fs) {
+  // s = K (1 - z^-1) / (1 + z^-1), K = 2 fs
+  float k = 2.0f * fs;
+  float k2 = k * k;
+  float A0 = a2 * k2 + a1 * k + a0;
+
+  BiquadCoeffs c;
+  c.b0 = (b2 * k2 + b1 * k + b0) / A0;
+  c.b1 = (2.0f * (b0 - b2 * k2)) / A0;
+  c.b2 = (b2 * k2 - b1 * k + b0) / A0;
+  c.a1 = (2.0f * (a0 - a2 * k2)) / A0;
+  c.a2 = (a2 * k2 - a1 * k + a0) / A0;
+  return c;
+}
+
+BiquadCoeffs Biquad::highpass(float f0, float q, float fs) {
+  float w0 = 2.0f * (float)M_PI * f0 / fs;
+  float cw = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+  float a0 = 1.0f + alpha;
+
+  BiquadCoeffs c;
+  c.b0 = (1.0f + cw) / 2.0f / a0;
+  c.b1 = -(1.0f + cw) / a0;
+  c.b2 = c.b0;
+  c.a1 = -2.0f * cw / a0;
+  c.a2 = (1.0f - alpha) / a0;
+  return c;
+}
+
+BiquadCoeffs Biquad::lowpass(float f0, float q, float fs) {
+  float w0 = 2.0f * (float)M_PI * f0 / fs;
+  float cw = cosf(w0);
+  float alpha = sinf(w0) / (2.0f * q);
+  float a0 = 1.0f + alpha;
+
+  BiquadCoeffs c;
+  c.b0 = (1.0f - cw) / 2.0f / a0;
+  c.b1 = (1.0f - cw) / a0;
+  c.b2 = c.b0;
+  c.a1 = -2.0f * cw / a0;
+  c.a2 = (1.0f - alpha) / a0;
+  return c;
+}
+
+float Biquad::magnitude(const BiquadCoeffs& c, float f, float fs) {
+  float w = 2.0f * (float)M_PI * f / fs;
+  float c1 = cosf(w), s1 = sinf(w);
+  float c2 = cosf(2.0f * w), s2 = sinf(2.0f * w);
+
+  // z^-1 = cos w - j sin w
+  float nr = c.b0 + c.b1 * c1 + c.b2 * c2;
+  float ni = -(c.b1 * s1 + c.b2 * s2);
+  float dr = 1.0f + c.a1 * c1 + c.a2 * c2;
+  float di = -(c.a1 * s1 + c.a2 * s2);
+  return sqrtf((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+bool FilterChain::add(const BiquadCoeffs& c) {
+  if (count >= MAX_SECTIONS) return false;
+  stages[count++].set(c);
+  return true;
+}
+
+void FilterChain::reset() {
+  for (int i = 0; i < count; i++) stages[i].reset();
+}
+
+void FilterChain::process(const int16_t* in, int16_t* out, size_t n) {
+  const int shift = Biquad::STATE_SHIFT;
+  for (size_t i = 0; i < n; i++) {
+    int32_t v = (int32_t)in[i] << shift;
+    for (int s = 0; s < count; s++) {
+      v = stages[s].process(v);
+    }
+    v = (v + (1 << (shift - 1))) >> shift;
+    if (v > INT16_MAX) v = INT16_MAX;
+    if (v < INT16_MIN) v = INT16_MIN;
+    out[i] = (int16_t)v;
+  }
+}
+
+// 주파수 f(Hz)를 쌍선형 변환의 주파수 왜곡을 보정한 아날로그 각주파수로
+static float prewarp(float f, float fs) {
+  return 2.0f * fs * tanf((float)M_PI * f / fs);
+}
+
+void designAWeighting(FilterChain& chain, float fs) {
+  // A 가중 극점 (IEC 61672): 20.6Hz(중근), 107.7Hz, 737.9Hz, 12194Hz(중근), 영점 4개는 0Hz
+  float w1 = prewarp(20.598997f, fs);
+  float w2 = prewarp(107.65265f, fs);
+  float w3 = prewarp(737.86223f, fs);
+  float w4 = prewarp(12194.217f, fs);
+
+  BiquadCoeffs s1 = Biquad::bilinear(1, 0, 0, 1, 2 * w1, w1 * w1, fs);       // s^2 / (s + w1)^2
+  BiquadCoeffs s2 = Biquad::bilinear(1, 0, 0, 1, w2 + w3, w2 * w3, fs);     // s^2 / ((s + w2)(s + w3))
+  BiquadCoeffs s3 = Biquad::bilinear(0, 0, w4 * w4, 1, 2 * w4, w4 * w4, fs); // w4^2 / (s + w4)^2
+
+  // 1kHz에서 0dB가 되도록 마지막 구간에서 이득 보정
+  float g = Biquad::magnitude(s1, 1000, fs) * Biquad::magnitude(s2, 1000, fs) * Biquad::magnitude(s3, 1000, fs);
+  s3.b0 /= g;
+  s3.b1 /= g;
+  s3.b2 /= g;
+
+  chain.clear();
+  chain.add(s1);
+  chain.add(s2);
+  chain.add(s3);
+}
+
+void designBandpass(FilterChain& chain, float lowHz, float highHz, float fs) {
+  chain.clear();
+  chain.add(Biquad::highpass(lowHz, 0.70710678f, fs));
+  chain.add(Biquad::lowpass(highHz, 0.70710678f, fs));
+}
@@ -0,0 +1,69 @@
+// biquad.h
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 고정소수점 2차 IIR 필터(biquad) 구간
+// 계수는 float로 설계한 뒤 Q28로 양자화하고, 샘플 처리는 정수 연산만 사용합니다.
+// 내부 상태는 입력보다 STATE_SHIFT 비트 더 정밀하게 유지하고, 잘린 하위 비트는 다음 샘플에 되먹여
+// (error feedback) 극점이 저주파에 몰린 구간에서도 반올림 잡음이 커지지 않게 합니다.
+struct BiquadCoeffs {
+  float b0, b1, b2, a1, a2; // a0 = 1로 정규화
+};
+
+class Biquad {
+public:
+  static const int COEFF_BITS = 28;
+  static const int STATE_SHIFT = 8;
+
+  void set(const BiquadCoeffs& c);
+  void reset();
+
+  // 상태 단위(샘플 << STATE_SHIFT) 입출력
+  int32_t process(int32_t x);
+
+  // 아날로그 2차 전달함수 (b2 s^2 + b1 s + b0) / (a2 s^2 + a1 s + a0) 를 쌍선형 변환
+  static BiquadCoeffs bilinear(float b2, float b1, float b0, float a2, float a1, float a0, float fs);
+
+  // RBJ Audio EQ Cookbook 2차 고역/저역 통과 필터
+  static BiquadCoeffs highpass(float f0, float q, float fs);
+  static BiquadCoeffs lowpass(float f0, float q, float fs);
+
+  // f에서의 이득 크기 (정규화용)
+  static float magnitude(const BiquadCoeffs& c, float f, float fs);
+
+private:
+  int32_t b0 = 0, b1 = 0, b2 = 0, a1 = 0, a2 = 0; // Q28
+  int32_t x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+  int64_t err = 0; // 직전 출력에서 잘린 하위 비트
+};
+
+// 여러 구간을 직렬로 연결한 필터. int16 PCM을 받아 int16으로 포화시켜 출력
+class FilterChain {
+public:
+  static const int MAX_SECTIONS = 3;
+
+  void clear() { count = 0; }
+  bool add(const BiquadCoeffs& c);
+  void reset();
+
+  void process(const int16_t* in, int16_t* out, size_t n);
+
+  int sections() const { return count; }
+  Biquad& section(int i) { return stages[i]; }
+
+private:
+  Biquad stages[MAX_SECTIONS];
+  int count = 0;
+};
+
+// IEC 61672 A 가중 필터를 세 구간으로 설계 (1kHz에서 0dB)
+void designAWeighting(FilterChain& chain, float fs);
+
+// 2차 버터워스 고역 + 저역 통과로 이루어진 대역 통과 필터
+void designBandpass(FilterChain& chain, float lowHz, float highHz, float fs);
+
+#endif
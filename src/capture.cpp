@@ -0,0 +1,183 @@
+// capture.cpp
+
+#include "config.h"
+#include "capture.h"
+#include "metrics.h"
+#include <atomic>
+#include <esp_heap_caps.h>
+
+static const uint32_t RING_MASK = CAPTURE_RING_SAMPLES - 1;
+static_assert((CAPTURE_RING_SAMPLES & RING_MASK) == 0, "CAPTURE_RING_SAMPLES는 2의 거듭제곱이어야 합니다");
+
+// 캡처 Task가 다음 블록을 쓰는 중에도 안전하게 읽을 수 있는 최대 과거 길이
+static const uint32_t RING_READABLE = CAPTURE_RING_SAMPLES - 2 * CAPTURE_BLOCK_SAMPLES;
+
+static const int MAX_WAITERS = 4; // captureWait()로 동시에 대기할 수 있는 Task 수
+
+static int16_t* ring = NULL;
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> overruns(0);
+static QueueHandle_t eventQueue = NULL;
+static TaskHandle_t captureTaskHandle = NULL;
+
+static Counter overrunCounter("pet_i2s_overruns_total", "I2S DMA queue overflows (capture task too late)", nullptr,
+                              []() -> uint32_t { return overruns.load(std::memory_order_relaxed); });
+static Counter sampleCounter("pet_capture_samples_total", "Audio samples captured", nullptr,
+                             []() -> uint32_t { return head.load(std::memory_order_relaxed); });
+
+static TaskHandle_t waiters[MAX_WAITERS];
+static portMUX_TYPE waitersMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 대기 중인 소비자 Task를 모두 깨움
+static void notifyWaiters() {
+  portENTER_CRITICAL(&waitersMux);
+  for (int i = 0; i < MAX_WAITERS; i++) {
+    if (waiters[i]) {
+      xTaskNotifyGive(waiters[i]);
+      waiters[i] = NULL;
+    }
+  }
+  portEXIT_CRITICAL(&waitersMux);
+}
+
+// DMA에 완료된 버퍼가 남아 있지 않을 때까지 링 버퍼로 옮김 (중간 버퍼 없음)
+static void drainDma() {
+  for (;;) {
+    uint32_t seq = head.load(std::memory_order_relaxed);
+    uint32_t offset = seq & RING_MASK;
+    // 링 끝을 넘지 않는 범위에서 DMA 버퍼 하나만큼 읽음
+    size_t want = min(CAPTURE_BLOCK_SAMPLES, CAPTURE_RING_SAMPLES - offset);
+
+    size_t bytes_read = 0;
+    i2s_read(I2S_PORT, ring + offset, want * sizeof(int16_t), &bytes_read, 0);
+    if (bytes_read == 0) break;
+
+    // 데이터를 다 쓴 뒤에 순번을 공개 (소비자는 head 미만만 읽음)
+    head.store(seq + bytes_read / sizeof(int16_t), std::memory_order_release);
+  }
+  notifyWaiters();
+}
+
+// 캡처 Task: DMA 버퍼가 찰 때마다(RX_DONE) 깨어나 I2S를 비움
+static void capture_task_function(void *pvParameters) {
+  i2s_event_t event;
+  for (;;) {
+    if (xQueueReceive(eventQueue, &event, portMAX_DELAY) != pdTRUE) continue;
+
+    if (event.type == I2S_EVENT_RX_DONE) {
+      drainDma();
+    } else if (event.type == I2S_EVENT_RX_Q_OVF) {
+      // DMA 버퍼 8개가 모두 찰 때까지 Task가 실행되지 못함 → 가장 오래된 블록 유실
+      overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool setupCapture(QueueHandle_t i2sEventQueue) {
+  if (!i2sEventQueue) {
+    D_PRINTLN("I2S 이벤트 큐가 없습니다!");
+    return false;
+  }
+  eventQueue = i2sEventQueue;
+
+  ring = (int16_t*)heap_caps_malloc(CAPTURE_RING_SAMPLES * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+  if (!ring) {
+    D_PRINTLN("캡처 링 버퍼(PSRAM) 할당 실패!");
+    return false;
+  }
+
+  // 캡처는 블록당 2KB 복사뿐이라 짧게 끝나므로, 인코딩/웹 서버/async_tcp보다 높은 우선순위로 둠
+  // (WiFi Task보다는 낮게)
+  xTaskCreatePinnedToCore(
+      capture_task_function,  // Task 함수
+      "Capture Task",         // Task 이름
+      4096,                   // Stack 크기
+      NULL,                   // Task 파라미터
+      CAPTURE_TASK_PRIORITY,  // 우선순위
+      &captureTaskHandle,     // Task 핸들
+      1);                     // Core 1에서 실행
+
+  D_PRINTF("캡처 링 버퍼 %u 샘플 (%.1f초) 할당 완료.\n",
+           (unsigned)CAPTURE_RING_SAMPLES, (float)CAPTURE_RING_SAMPLES / SAMPLE_RATE);
+  return true;
+}
+
+uint32_t captureHead() {
+  return head.load(std::memory_order_acquire);
+}
+
+uint32_t captureSeqBefore(uint32_t ms) {
+  uint32_t now = captureHead();
+  uint32_t back = (uint32_t)((uint64_t)ms * SAMPLE_RATE / 1000);
+  if (back > RING_READABLE) back = RING_READABLE;
+  if (back > now) back = now; // 부팅 직후에는 기록된 만큼만
+  return now - back;
+}
+
+uint32_t captureClamp(uint32_t seq) {
+  uint32_t now = captureHead();
+  int32_t back = (int32_t)(now - seq);
+  if (back < 0) return now; // 아직 기록되지 않은 위치
+  uint32_t limit = min(RING_READABLE, now); // 덮어써진 위치 / 부팅 직후
+  return (uint32_t)back > limit ? now - limit : seq;
+}
+
+void captureReaderBegin(CaptureReader& reader, uint32_t seq) {
+  reader.seq = seq;
+  reader.dropped = 0;
+}
+
+size_t captureAcquire(CaptureReader& reader, const int16_t** data, size_t maxSamples) {
+  uint32_t now = captureHead();
+  uint32_t available = now - reader.seq;
+
+  // 덮어써졌거나 곧 덮어써질 위치면 읽을 수 있는 가장 오래된 위치로 건너뜀
+  if (available > RING_READABLE) {
+    uint32_t oldest = now - RING_READABLE;
+    reader.dropped += oldest - reader.seq;
+    reader.seq = oldest;
+    available = RING_READABLE;
+  }
+  if (available == 0) return 0;
+
+  uint32_t offset = reader.seq & RING_MASK;
+  *data = ring + offset;
+  size_t n = min(available, CAPTURE_RING_SAMPLES - offset); // 링 끝에서 끊음
+  return min(n, maxSamples);
+}
+
+size_t captureRelease(CaptureReader& reader, size_t n) {
+  // 캡처 Task는 head부터 최대 한 블록을 쓰는 중일 수 있으므로, RING_READABLE보다 오래된 위치는 덮어써졌을 수 있음
+  uint32_t behind = captureHead() - reader.seq;
+  size_t overwritten = 0;
+  if (behind > RING_READABLE) {
+    overwritten = min((size_t)(behind - RING_READABLE), n);
+    reader.dropped += overwritten;
+  }
+  reader.seq += n;
+  return overwritten;
+}
+
+bool captureWait(const CaptureReader& reader, TickType_t timeout) {
+  if (captureHead() != reader.seq) return true;
+
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&waitersMux);
+  for (int i = 0; i < MAX_WAITERS; i++) {
+    if (!waiters[i] || waiters[i] == self) {
+      waiters[i] = self;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&waitersMux);
+
+  // 등록 직전에 공개된 블록을 놓치지 않도록 한 번 더 확인
+  if (captureHead() == reader.seq) {
+    ulTaskNotifyTake(pdTRUE, timeout);
+  }
+  return captureHead() != reader.seq;
+}
+
+uint32_t captureOverruns() {
+  return overruns.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,53 @@
+// capture.h
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+
+// I2S 캡처 링 버퍼
+// 우선순위가 높은 전용 캡처 Task만 I2S를 읽습니다. DMA 버퍼가 찰 때마다(RX_DONE 이벤트) 해당 블록을
+// PSRAM 링 버퍼에 바로 기록하고, 샘플마다 누적 순번(sequence)을 붙입니다.
+// 생산자는 하나, 소비자(소음 감지, 녹음, 라이브 스트림)는 각자 CaptureReader로 순번을 관리하며 락 없이 읽습니다.
+// 느린 소비자는 생산자를 막지 않고, 덮어써진 구간은 건너뛰며 dropped에 기록됩니다.
+
+struct CaptureReader {
+  uint32_t seq = 0;     // 다음에 읽을 샘플 순번
+  uint32_t dropped = 0; // 따라가지 못해 건너뛰었거나, 사용 중 덮어써진 샘플 수
+};
+
+// 링 버퍼 할당, I2S 이벤트 큐 연결 및 캡처 Task 시작
+// i2sEventQueue는 i2s_driver_install()에 넘긴 이벤트 큐
+bool setupCapture(QueueHandle_t i2sEventQueue);
+
+// 지금까지 기록된 총 샘플 수 = 다음에 기록될 샘플의 순번
+uint32_t captureHead();
+
+// 현재 위치에서 ms만큼 과거의 순번. 링에 남아 있는 가장 오래된 샘플보다 앞서지 않도록 제한됨
+uint32_t captureSeqBefore(uint32_t ms);
+
+// seq를 현재 링에서 읽을 수 있는 범위로 제한 (너무 오래됐거나 아직 기록되지 않은 위치 보정)
+uint32_t captureClamp(uint32_t seq);
+
+// reader를 seq 위치에서 시작
+void captureReaderBegin(CaptureReader& reader, uint32_t seq);
+
+// reader 위치부터 연속으로 읽을 수 있는 구간을 링 내부 포인터로 돌려줌 (복사 없음, 최대 maxSamples)
+// 반환값은 샘플 수. 0이면 새 데이터 없음. 덮어써진 위치였다면 가장 오래된 유효 위치로 건너뜀
+size_t captureAcquire(CaptureReader& reader, const int16_t** data, size_t maxSamples);
+
+// captureAcquire로 받은 구간 중 n 샘플 사용 완료
+// 사용하는 동안 캡처 Task가 그 구간을 덮어썼는지 확인해, 덮어써졌을 수 있는 샘플 수를 dropped에 더하고 반환
+// (0이 아니면 방금 인코딩/분석한 데이터가 손상됨). 한 번에 CAPTURE_BLOCK_SAMPLES 이하로 받아 쓰면
+// 읽을 수 있는 가장 오래된 위치에서도 캡처 Task보다 블록 2개만큼 여유가 있음
+size_t captureRelease(CaptureReader& reader, size_t n);
+
+// reader 위치에 새 데이터가 들어올 때까지 현재 Task를 재움. 데이터가 있으면 true
+bool captureWait(const CaptureReader& reader, TickType_t timeout);
+
+// I2S DMA 수신 큐 오버플로 횟수 (캡처 Task가 DMA를 제때 비우지 못한 경우)
+uint32_t captureOverruns();
+
+#endif
@@ -0,0 +1,200 @@
+// classifier.cpp
+
+#include "config.h"
+#include "classifier.h"
+#include "capture.h"
+
+static const int FFT_BITS = 9;
+static const int FFT_SIZE = 1 << FFT_BITS; // 512 샘플 ≈ 11.6ms, 빈 간격 ≈ 86Hz
+static const int BINS = FFT_SIZE / 2 + 1;
+
+// ESP32-S3는 단정밀도 FPU가 있으므로 FFT는 float로 계산
+static float window[FFT_SIZE];
+static float twiddle[FFT_SIZE];   // cos/sin 교대 (FFT_SIZE/2개 복소수)
+static float frame[2 * FFT_SIZE]; // 실수/허수 교대
+static float power[BINS];
+
+static ClassifierResult lastResult;
+static ClassifierStats stats;
+static portMUX_TYPE resultMux = portMUX_INITIALIZER_UNLOCKED;
+
+void setupClassifier() {
+  for (int i = 0; i < FFT_SIZE; i++) {
+    window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / FFT_SIZE); // Hann
+  }
+  for (int k = 0; k < FFT_SIZE / 2; k++) {
+    twiddle[2 * k] = cosf(2.0f * (float)M_PI * k / FFT_SIZE);
+    twiddle[2 * k + 1] = -sinf(2.0f * (float)M_PI * k / FFT_SIZE);
+  }
+}
+
+// 제자리 radix-2 복소 FFT
+static void fft(float* x) {
+  for (int i = 1, j = 0; i < FFT_SIZE; i++) {
+    int bit = FFT_SIZE >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j |= bit;
+    if (i < j) {
+      float tr = x[2 * i], ti = x[2 * i + 1];
+      x[2 * i] = x[2 * j];
+      x[2 * i + 1] = x[2 * j + 1];
+      x[2 * j] = tr;
+      x[2 * j + 1] = ti;
+    }
+  }
+
+  for (int len = 2; len <= FFT_SIZE; len <<= 1) {
+    int half = len >> 1;
+    int step = FFT_SIZE / len;
+    for (int i = 0; i < FFT_SIZE; i += len) {
+      for (int k = 0; k < half; k++) {
+        float wr = twiddle[2 * k * step], wi = twiddle[2 * k * step + 1];
+        float* a = x + 2 * (i + k);
+        float* b = x + 2 * (i + k + half);
+        float tr = b[0] * wr - b[1] * wi;
+        float ti = b[0] * wi + b[1] * wr;
+        b[0] = a[0] - tr;
+        b[1] = a[1] - ti;
+        a[0] += tr;
+        a[1] += ti;
+      }
+    }
+  }
+}
+
+// 캡처 링에서 FFT_SIZE 샘플을 읽어 창함수를 곱한 프레임을 만듦. 시간 영역 에너지를 반환
+static bool readFrame(CaptureReader& reader, uint32_t endSeq, float* energy) {
+  if (endSeq - reader.seq < (uint32_t)FFT_SIZE) return false;
+
+  float e = 0;
+  int filled = 0;
+  while (filled < FFT_SIZE) {
+    const int16_t* pcm;
+    size_t n = captureAcquire(reader, &pcm, FFT_SIZE - filled);
+    if (n == 0) return false;
+    for (size_t i = 0; i < n; i++, filled++) {
+      float s = pcm[i] / 32768.0f;
+      e += s * s;
+      frame[2 * filled] = s * window[filled];
+      frame[2 * filled + 1] = 0;
+    }
+    captureRelease(reader, n);
+  }
+  *energy = e;
+  return true;
+}
+
+static void extractFeatures(int frames, float peakEnergy, float totalEnergy, SoundFeatures& f) {
+  const float binHz = (float)SAMPLE_RATE / FFT_SIZE;
+  const int lowBin = (int)(BARK_BAND_LOW_HZ / binHz);
+  const int highBin = (int)(BARK_BAND_HIGH_HZ / binHz);
+  const int minBin = (int)(100.0f / binHz) + 1;  // 100Hz ~ 8kHz
+  const int maxBin = (int)(8000.0f / binHz);
+
+  float total = 0, low = 0, band = 0, high = 0;
+  for (int k = 1; k < BINS; k++) {
+    float p = power[k];
+    total += p;
+    if (k < lowBin) low += p;
+    else if (k <= highBin) band += p;
+    else high += p;
+  }
+
+  // 무게중심과 평탄도는 8kHz 이상 잡음에 끌려가지 않도록 관심 대역에서만 계산
+  float logSum = 0, linSum = 0, weighted = 0;
+  for (int k = minBin; k <= maxBin; k++) {
+    float p = power[k] / frames + 1e-12f;
+    logSum += logf(p);
+    linSum += p;
+    weighted += p * k * binHz;
+  }
+  int count = maxBin - minBin + 1;
+
+  f.centroidHz = linSum > 0 ? weighted / linSum : 0;
+  f.flatness = linSum > 0 ? expf(logSum / count) / (linSum / count) : 1;
+  f.lowShare = total > 0 ? low / total : 0;
+  f.barkShare = total > 0 ? band / total : 0;
+  f.highShare = total > 0 ? high / total : 0;
+  f.peakShare = totalEnergy > 0 ? peakEnergy / totalEnergy : 0;
+}
+
+static SoundClass decide(const SoundFeatures& f) {
+  if (f.barkShare < CLASSIFY_MIN_BARK_SHARE) return SOUND_OTHER;
+  if (f.peakShare > CLASSIFY_SLAM_PEAK_SHARE) return SOUND_OTHER;
+  if (f.centroidHz < CLASSIFY_MIN_CENTROID_HZ || f.centroidHz > CLASSIFY_MAX_CENTROID_HZ) return SOUND_OTHER;
+  if (f.flatness < CLASSIFY_WHINE_MAX_FLATNESS) return SOUND_WHINE;
+  if (f.flatness < CLASSIFY_BARK_MAX_FLATNESS) return SOUND_BARK;
+  return SOUND_OTHER;
+}
+
+bool classifyTrigger(bool forced, uint32_t endSeq, ClassifierResult& out) {
+  unsigned long start = micros();
+
+  // 판정 시점 이전 구간. 링에 남아 있지 않은 부분은 captureClamp로 잘림
+  CaptureReader reader;
+  captureReaderBegin(reader, captureClamp(endSeq - (uint32_t)SAMPLE_RATE * CLASSIFY_MS / 1000));
+
+  for (int k = 0; k < BINS; k++) power[k] = 0;
+
+  // 프레임별 평균 파워 스펙트럼 + 프레임 에너지 상위 2개
+  int frames = 0;
+  float energy, totalEnergy = 0, top1 = 0, top2 = 0;
+  while (readFrame(reader, endSeq, &energy)) {
+    fft(frame);
+    for (int k = 0; k < BINS; k++) {
+      power[k] += frame[2 * k] * frame[2 * k] + frame[2 * k + 1] * frame[2 * k + 1];
+    }
+    totalEnergy += energy;
+    if (energy > top1) {
+      top2 = top1;
+      top1 = energy;
+    } else if (energy > top2) {
+      top2 = energy;
+    }
+    frames++;
+  }
+
+  out = ClassifierResult();
+  out.forced = forced;
+  out.at = millis();
+  if (frames > 0) {
+    extractFeatures(frames, top1 + top2, totalEnergy, out.features);
+    out.cls = decide(out.features);
+  }
+  bool record = forced || out.cls != SOUND_OTHER;
+
+  portENTER_CRITICAL(&resultMux);
+  lastResult = out;
+  stats.counts[out.cls]++;
+  if (record) stats.recorded++;
+  else stats.skipped++;
+  stats.lastMicros = micros() - start;
+  portEXIT_CRITICAL(&resultMux);
+
+  D_PRINTF("소리 분류: %s (무게중심 %.0fHz, 평탄도 %.2f, 짖음 대역 %.0f%%, 피크 %.0f%%, %lu us)\n",
+           soundClassName(out.cls), out.features.centroidHz, out.features.flatness,
+           out.features.barkShare * 100, out.features.peakShare * 100, micros() - start);
+  return record;
+}
+
+const char* soundClassName(SoundClass cls) {
+  switch (cls) {
+    case SOUND_BARK: return "bark";
+    case SOUND_WHINE: return "whine";
+    default: return "other";
+  }
+}
+
+ClassifierResult lastClassification() {
+  portENTER_CRITICAL(&resultMux);
+  ClassifierResult copy = lastResult;
+  portEXIT_CRITICAL(&resultMux);
+  return copy;
+}
+
+ClassifierStats classifierStats() {
+  portENTER_CRITICAL(&resultMux);
+  ClassifierStats copy = stats;
+  portEXIT_CRITICAL(&resultMux);
+  return copy;
+}
@@ -0,0 +1,53 @@
+// classifier.h
+
+#ifndef CLASSIFIER_H
+#define CLASSIFIER_H
+
+#include <stdint.h>
+
+// 캡처 링의 최근 구간을 FFT로 분석해 짖음/낑낑거림/기타로 분류합니다.
+// 트리거가 걸린 뒤 녹음(인코딩+업로드)을 시작할지 결정하는 데 사용합니다.
+enum SoundClass {
+  SOUND_OTHER = 0,
+  SOUND_BARK,
+  SOUND_WHINE,
+  SOUND_CLASS_COUNT
+};
+
+struct SoundFeatures {
+  float centroidHz;    // 스펙트럼 무게중심
+  float flatness;      // 스펙트럼 평탄도 (0 = 순음, 1 = 백색 잡음)
+  float lowShare;      // BARK_BAND_LOW_HZ 미만 에너지 비율
+  float barkShare;     // 짖음 대역 에너지 비율
+  float highShare;     // BARK_BAND_HIGH_HZ 초과 에너지 비율
+  float peakShare;     // 가장 센 두 프레임의 에너지 비율 (충격음일수록 큼)
+};
+
+struct ClassifierResult {
+  SoundClass cls = SOUND_OTHER;
+  SoundFeatures features = {};
+  bool forced = false;   // 강제 녹음 (분류와 무관하게 녹음)
+  unsigned long at = 0;  // 분류 시각 (millis)
+};
+
+struct ClassifierStats {
+  uint32_t counts[SOUND_CLASS_COUNT] = {}; // 분류 결과별 횟수
+  uint32_t recorded = 0;                   // 녹음으로 이어진 트리거
+  uint32_t skipped = 0;                    // 분류 결과로 녹음을 생략한 트리거 (아낀 인코딩 횟수)
+  uint32_t lastMicros = 0;                 // 마지막 분류에 걸린 시간
+};
+
+// FFT 테이블 준비
+void setupClassifier();
+
+// 캡처 링에서 endSeq 직전 CLASSIFY_MS 구간을 분류. forced면 결과와 관계없이 녹음하는 것으로 기록
+// 녹음해야 하면 true
+bool classifyTrigger(bool forced, uint32_t endSeq, ClassifierResult& out);
+
+const char* soundClassName(SoundClass cls);
+
+// 다른 Task(웹 서버, 오디오 Task)에서 읽기 위한 복사본
+ClassifierResult lastClassification();
+ClassifierStats classifierStats();
+
+#endif
@@ -54,22 +54,67 @@
 const int SAMPLE_RATE       = 44100; // 샘플링 속도
 const int BIT_DEPTH         = 16;
 const int NUM_CHANNELS      = 1;     // 모노
-const int RECORD_SECONDS    = 10;    // 녹음 시간(초)
+const int RECORD_MIN_SECONDS = 2;     // 트리거 이후 최소 녹음 시간(초)
+const int RECORD_MAX_SECONDS = 10;    // 트리거 이후 최대 녹음 시간(초)
+const int RECORD_HANGOVER_MS = 1500;  // 조용한 상태가 이만큼 이어지면 녹음 종료
+const int RECORD_MERGE_MAX_SECONDS = 30; // 녹음 중 들어온 트리거로 연장할 수 있는 최대 길이(초, 첫 트리거 기준)
+const int EVENT_QUEUE_LENGTH = 8;        // 녹음 중 대기할 수 있는 트리거 수
 
 // 소음 감지 설정
-#define SOUND_DETECT_DB           90.0f // 이 데시벨을 넘으면 녹음 시작
+#define SOUND_DETECT_DB           90.0f // 짖음 대역 레벨이 이 데시벨을 넘으면 녹음 시작
+#define BARK_BAND_LOW_HZ          400.0f  // 짖음 대역 (대역 통과 필터)
+#define BARK_BAND_HIGH_HZ         4000.0f
+#define BARK_MIN_SHARE_DB         -6.0f // 짖음 대역이 A 가중 전체 레벨 대비 이 이상이어야 함 (팬/히터 저주파 소음 배제)
+#define RECORD_QUIET_DB           (SOUND_DETECT_DB - 10.0f) // 녹음 중 짖음 대역 레벨이 이 아래면 조용한 것으로 판단
 #define REFERENCE_RMS             0.0501187f
-#define DB_CHECK_BUFFER_SIZE      1024
 const int REQUIRED_CONSECUTIVE_HITS = 3; // 연속으로 3번 이상 기준 데시벨 초과 시 녹음
 
-const uint32_t AUDIO_DATA_SIZE = RECORD_SECONDS * SAMPLE_RATE * NUM_CHANNELS * (BIT_DEPTH / 8);
+// 소리 분류 설정 (트리거 후 녹음 여부 결정)
+const int CLASSIFY_MS               = 600;   // 분류에 사용할 트리거 직전 구간 (ms)
+#define CLASSIFY_MIN_BARK_SHARE     0.40f  // 짖음 대역 에너지 비율이 이보다 낮으면 기타
+#define CLASSIFY_WHINE_MAX_FLATNESS 0.10f  // 이보다 평탄도가 낮으면(음정이 뚜렷하면) 낑낑거림
+#define CLASSIFY_BARK_MAX_FLATNESS  0.50f  // 이보다 평탄도가 높으면 잡음(기타)
+#define CLASSIFY_MIN_CENTROID_HZ    300.0f // 짖음/낑낑거림으로 볼 스펙트럼 무게중심 범위 (100Hz ~ 8kHz 기준)
+#define CLASSIFY_MAX_CENTROID_HZ    3500.0f
+#define CLASSIFY_SLAM_PEAK_SHARE    0.60f  // 가장 센 두 프레임(약 23ms)에 에너지가 이 이상 몰리면 충격음(문 닫힘 등)
+
+const uint32_t AUDIO_DATA_SIZE = RECORD_MAX_SECONDS * SAMPLE_RATE * NUM_CHANNELS * (BIT_DEPTH / 8);
 const int MP3_BITRATE       = 128;    // MP3 인코딩 비트레이트 (kbps)
-const uint32_t MP3_BUFFER_SIZE = 204800; // 100KB MP3 버퍼 (넉넉하게 설정)
+
+// 캡처 링 버퍼 설정 (PSRAM)
+const uint32_t CAPTURE_RING_SAMPLES  = 1 << 18; // 262144 샘플 ≈ 5.9초 (512KB), 2의 거듭제곱이어야 함
+const uint32_t CAPTURE_BLOCK_SAMPLES = 1024;    // I2S DMA 버퍼 하나 크기 (dma_buf_len)
+const int CAPTURE_DMA_BUFFERS        = 8;       // I2S DMA 버퍼 개수 (dma_buf_count), 캡처 Task가 늦어도 버틸 수 있는 여유 ≈ 186ms
+const int CAPTURE_TASK_PRIORITY      = 20;      // 캡처 Task 우선순위 (lwIP 18 < 캡처 < WiFi 23)
+const int PREROLL_MS                 = 2000;    // 녹음에 포함할 트리거 이전 구간 (ms), 링 길이보다 짧아야 함
+
+// 실시간 스트리밍 설정 (GET /live)
+const int LIVE_MAX_CLIENTS    = 3;    // 동시 청취자 수 상한
+const int LIVE_RING_FRAMES    = 64;   // 프레임 링 크기 (128kbps 기준 약 1.7초)
+const int LIVE_FRAME_MAX      = 1024; // 프레임 하나의 최대 바이트 (128kbps 프레임 ≈ 418)
+
+// 녹음 스풀 설정 (LittleFS)
+const size_t SPOOL_WRITE_BUFFER   = 4096;   // 플래시에 한 번에 기록하는 크기
+const size_t SPOOL_RESERVE_BYTES  = (size_t)MP3_BITRATE * 1000 / 8 * RECORD_MERGE_MAX_SECONDS + 32 * 1024; // 최장 녹음 1개 + 인덱스 여유
+const uint32_t SPOOL_RETRY_MIN_MS = 5000;   // 업로드 실패 후 첫 재시도 간격
+const uint32_t SPOOL_RETRY_MAX_MS = 300000; // 재시도 간격 상한 (5분)
+
+// 센서 데이터 일괄 업로드 설정
+const uint32_t TELEMETRY_SAMPLE_MS = 60000;   // 센서 샘플 기록 주기
+const uint32_t TELEMETRY_FLUSH_MS  = 900000;  // 대기 중인 샘플 전송 주기 (15분)
+const uint32_t TELEMETRY_CAPACITY  = 128;     // 샘플 링 크기 (2의 거듭제곱, 샘플당 8바이트)
+const uint32_t TELEMETRY_FLUSH_AT  = 96;      // 이만큼 쌓이면 주기를 기다리지 않고 전송
+const bool TELEMETRY_MSGPACK       = true;    // MessagePack으로 전송 (서버가 거절하고 JSON은 받으면 JSON으로 전환)
+
+// 업로드 서버 keep-alive 연결 설정
+const uint32_t UPLINK_IDLE_MS     = 10000; // 이보다 오래 쉰 연결은 서버가 닫았을 수 있으므로 새로 연결
+const uint32_t UPLINK_TIMEOUT_MS  = 5000;  // 응답 대기 시간
 
 
 // ------------------ 네트워크 및 서버 설정 -----------------
 extern const char* upload_server;
 extern const int   upload_port;
+extern const char* upload_telemetry_path;
 extern const char* upload_sensor_path;
 extern const char* upload_file_path;
 extern const char* device_id;
@@ -83,6 +128,15 @@ extern const int   daylightOffset_sec;
 // ------------------ 동작 주기 설정 -----------------------
 const long update_interval      = 1000; // 화면 센서 값 업데이트 주기
 const long sound_check_interval = 200; // 데시벨 측정 주기
+const uint32_t SENSOR_STALE_MS  = 5000; // 센서 스냅샷이 이보다 오래되면 사용하지 않음
+const uint32_t PUSH_INTERVAL_MS = 250;  // 클라이언트별 변경 푸시(/events) 최소 간격, 이 안의 변경은 하나로 합침
+const int PUSH_MAX_CLIENTS      = 4;    // /events 동시 연결 수 상한
+
+// ------------------ 웹 서버 설정 -----------------------
+const size_t STATUS_BODY_MAX    = 256;  // POST /status 본문 최대 크기, 넘으면 413
+const size_t COMMANDS_BODY_MAX  = 1024; // POST /commands 본문 최대 크기, 넘으면 413
+const size_t CONTROL_MAX_OPS    = 8;    // POST /commands 한 번에 보낼 수 있는 동작 수
+const uint32_t CONTROL_MAX_SECONDS = 7 * 24 * 3600; // 예약 동작 최대 시간 (초)
 
 // ------------------ 전역 객체 선언 -----------------------
 extern DHTesp dht;
@@ -99,7 +153,6 @@ struct DeviceState {
 extern DeviceState deviceState;
 
 // ------------------ FreeRTOS 핸들 선언 --------------------
-extern SemaphoreHandle_t audioSemaphore;
 extern TaskHandle_t audioTaskHandle;
 
 // ------------------ 전역 버퍼 선언 -----------------------
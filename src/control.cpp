@@ -0,0 +1,164 @@
+// control.cpp
+
+#include "config.h"
+#include "control.h"
+
+struct Schedule {
+  bool active;
+  bool duty;
+  bool finalOn;        // 예약이 끝난 뒤 상태
+  uint32_t start;      // 예약 시작 (millis)
+  uint32_t forMs;      // 0이면 무기한
+  uint32_t onMs;       // duty cycle 켜짐/꺼짐 시간
+  uint32_t offMs;
+  uint32_t phaseStart; // 현재 duty 구간 시작 (millis)
+};
+
+static Schedule schedules[ACT_COUNT] = {};
+static uint32_t version = 1;
+static time_t changedAt = 0;
+static portMUX_TYPE controlMux = portMUX_INITIALIZER_UNLOCKED;
+
+// 시간이 동기화되지 않았으면 0 (Last-Modified 생략)
+static time_t syncedNow() {
+  time_t now = time(NULL);
+  return now < 1600000000 ? 0 : now;
+}
+
+static bool& stateOf(Actuator target) {
+  return target == ACT_FAN ? deviceState.isFanOn : deviceState.isHeaterOn;
+}
+
+static int pinOf(Actuator target) {
+  return target == ACT_FAN ? FAN_CONTROL_PIN : MOSFET_PIN;
+}
+
+// controlMux 안에서 호출
+static bool writeOutput(Actuator target, bool on, time_t now) {
+  bool& state = stateOf(target);
+  digitalWrite(pinOf(target), on ? HIGH : LOW);
+  if (state == on) return false;
+  state = on;
+  version++;
+  changedAt = now;
+  return true;
+}
+
+// Nextion 버튼 표시를 실제 상태에 맞춤
+static void syncDisplay(Actuator target) {
+  bool on = stateOf(target);
+  myNex.writeNum(target == ACT_FAN ? "bt0.val" : "bt1.val", on ? 1 : 0);
+  D_PRINTF("%s 상태 변경: %s\n", target == ACT_FAN ? "팬" : "히터", on ? "ON" : "OFF");
+}
+
+static bool setOutput(Actuator target, bool on) {
+  time_t now = syncedNow();
+  portENTER_CRITICAL(&controlMux);
+  schedules[target].active = false;
+  bool changed = writeOutput(target, on, now);
+  portEXIT_CRITICAL(&controlMux);
+  return changed;
+}
+
+bool setFan(bool on) {
+  return setOutput(ACT_FAN, on);
+}
+
+bool setHeater(bool on) {
+  return setOutput(ACT_HEATER, on);
+}
+
+bool applyControl(const ControlOp* ops, size_t count, uint32_t expectedVersion, uint32_t* versionOut) {
+  time_t now = syncedNow();
+  uint32_t ms = millis();
+  bool touched[ACT_COUNT] = {};
+
+  portENTER_CRITICAL(&controlMux);
+  if (expectedVersion != 0 && expectedVersion != version) {
+    *versionOut = version;
+    portEXIT_CRITICAL(&controlMux);
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    const ControlOp& op = ops[i];
+    Schedule& s = schedules[op.target];
+    s = {};
+    if (op.dutyOnMs && op.dutyOffMs) {
+      s.active = true;
+      s.duty = true;
+      s.finalOn = false;
+      s.onMs = op.dutyOnMs;
+      s.offMs = op.dutyOffMs;
+      s.phaseStart = ms;
+      writeOutput(op.target, true, now);
+    } else {
+      s.active = op.forMs != 0;
+      s.finalOn = !op.on;
+      writeOutput(op.target, op.on, now);
+    }
+    s.start = ms;
+    s.forMs = op.forMs;
+    touched[op.target] = true;
+  }
+  *versionOut = version;
+  portEXIT_CRITICAL(&controlMux);
+
+  for (int t = 0; t < ACT_COUNT; t++) {
+    if (touched[t]) syncDisplay((Actuator)t);
+  }
+  return true;
+}
+
+void handleControl() {
+  time_t now = syncedNow();
+  uint32_t ms = millis();
+  bool changed[ACT_COUNT] = {};
+
+  portENTER_CRITICAL(&controlMux);
+  for (int t = 0; t < ACT_COUNT; t++) {
+    Schedule& s = schedules[t];
+    if (!s.active) continue;
+    Actuator target = (Actuator)t;
+    if (s.forMs && ms - s.start >= s.forMs) {
+      s.active = false;
+      changed[t] = writeOutput(target, s.finalOn, now);
+    } else if (s.duty && ms - s.phaseStart >= (stateOf(target) ? s.onMs : s.offMs)) {
+      s.phaseStart = ms;
+      changed[t] = writeOutput(target, !stateOf(target), now);
+    }
+  }
+  portEXIT_CRITICAL(&controlMux);
+
+  for (int t = 0; t < ACT_COUNT; t++) {
+    if (changed[t]) syncDisplay((Actuator)t);
+  }
+}
+
+ControlSchedule controlSchedule(Actuator target) {
+  ControlSchedule out = {};
+  uint32_t ms = millis();
+  portENTER_CRITICAL(&controlMux);
+  const Schedule& s = schedules[target];
+  out.active = s.active;
+  out.duty = s.duty;
+  if (s.active && s.forMs) {
+    uint32_t elapsed = ms - s.start;
+    out.remainingMs = elapsed < s.forMs ? s.forMs - elapsed : 0;
+  }
+  portEXIT_CRITICAL(&controlMux);
+  return out;
+}
+
+uint32_t deviceStateVersion() {
+  portENTER_CRITICAL(&controlMux);
+  uint32_t v = version;
+  portEXIT_CRITICAL(&controlMux);
+  return v;
+}
+
+time_t deviceStateChangedAt() {
+  portENTER_CRITICAL(&controlMux);
+  time_t t = changedAt;
+  portEXIT_CRITICAL(&controlMux);
+  return t;
+}
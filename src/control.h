@@ -0,0 +1,51 @@
+// control.h
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// 팬/히터 제어
+// 웹(POST /status, POST /commands)과 Nextion 버튼 모두 이 모듈로 상태를 바꾸며, 실제로 바뀔 때마다 상태 버전이 올라갑니다.
+// 버전은 GET /status의 ETag로 쓰여, 상태가 그대로면 클라이언트는 본문 없이 304를 받습니다.
+//
+// 예약 동작: 일정 시간 뒤 반대 상태로 되돌리기(예: 팬 15분 켜기)와 켜짐/꺼짐 반복(duty cycle).
+// 예약은 loop()의 handleControl()이 실행하며, setFan()/setHeater()로 직접 바꾸면 해당 장치의 예약은 취소됩니다.
+
+enum Actuator { ACT_FAN, ACT_HEATER, ACT_COUNT };
+
+struct ControlOp {
+  Actuator target;
+  bool on;            // 켜기/끄기 (duty cycle은 켜진 상태부터 시작)
+  uint32_t forMs;     // 0이 아니면 이 시간 뒤 반대 상태로 (duty cycle이면 꺼짐으로) 되돌림
+  uint32_t dutyOnMs;  // 둘 다 0이 아니면 duty cycle
+  uint32_t dutyOffMs;
+};
+
+struct ControlSchedule {
+  bool active;
+  bool duty;
+  uint32_t remainingMs; // 종료까지 남은 시간, 0이면 무기한 (duty cycle)
+};
+
+// 상태가 실제로 바뀌었으면 true. 해당 장치의 예약은 취소됨
+bool setFan(bool on);
+bool setHeater(bool on);
+
+// ops를 순서대로 한 번에 적용 (적용 중에는 다른 변경이 끼어들 수 없음)
+// expectedVersion이 0이 아니고 현재 버전과 다르면 아무것도 바꾸지 않고 false
+// version에는 적용 후(거절 시에는 현재) 상태 버전이 기록됨
+bool applyControl(const ControlOp* ops, size_t count, uint32_t expectedVersion, uint32_t* version);
+
+// loop()에서 호출. 시간이 된 예약 동작 실행
+void handleControl();
+
+ControlSchedule controlSchedule(Actuator target);
+
+uint32_t deviceStateVersion();
+// 마지막으로 상태가 바뀐 시각 (epoch 초, 시간 동기화 전이면 0)
+time_t deviceStateChangedAt();
+
+#endif
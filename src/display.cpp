@@ -5,6 +5,7 @@
 #include "network.h" // enterAPMode() 호출을 위해 포함
 #include "sensors.h" // forceUploadSensorData() 호출을 위해 포함
 #include "audio.h"   // forceRecordAndUpload() 호출을 위해 포함
+#include "control.h" // setFan(), setHeater()
 
 // 디스플레이 초기화
 void setupDisplay() {
@@ -26,8 +27,7 @@ void updateDisplay(float temp, float humi, float co2, long rssi, bool occupied)
 
 // 팬 On/Off 버튼
 void trigger0() {
-  deviceState.isFanOn = !deviceState.isFanOn;
-  digitalWrite(FAN_CONTROL_PIN, deviceState.isFanOn ? HIGH : LOW);
+  setFan(!deviceState.isFanOn);
   D_PRINTLN(deviceState.isFanOn ? "FAN ON" : "FAN OFF");
 }
 
@@ -43,8 +43,7 @@ void trigger2() {
 
 // 히터 On/Off 버튼
 void trigger3() {
-  deviceState.isHeaterOn = !deviceState.isHeaterOn;
-  digitalWrite(MOSFET_PIN, deviceState.isHeaterOn ? HIGH : LOW);
+  setHeater(!deviceState.isHeaterOn);
   D_PRINTLN(deviceState.isHeaterOn ? "HEATER ON" : "HEATER OFF");
 }
 
@@ -0,0 +1,86 @@
+// events.cpp
+
+#include "config.h"
+#include "events.h"
+#include "metrics.h"
+
+static QueueHandle_t triggerQueue = NULL;
+static volatile uint32_t recordedSeq = 0;
+static volatile bool hasRecorded = false;
+static volatile uint32_t dropped = 0;
+
+static Counter droppedCounter("pet_triggers_dropped_total", "Triggers dropped because the event queue was full", nullptr,
+                              []() -> uint32_t { return dropped; });
+
+void RecordingEvent::add(const Trigger& t) {
+  if (triggers == 0) first = t;
+  if (triggers < MAX_TRIGGERS) {
+    seqs[triggers] = t.seq;
+  }
+  reasons |= t.reason;
+  triggers++;
+}
+
+void setupEvents() {
+  triggerQueue = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(Trigger));
+}
+
+bool postTrigger(TriggerReason reason, uint32_t seq, const ClassifierResult& cls) {
+  Trigger t;
+  t.reason = reason;
+  t.seq = seq;
+  t.at = millis();
+  t.cls = cls;
+
+  if (xQueueSend(triggerQueue, &t, 0) != pdTRUE) {
+    dropped++;
+    D_PRINTLN("트리거 큐가 가득 차 트리거를 버립니다.");
+    return false;
+  }
+  return true;
+}
+
+bool waitTrigger(Trigger& out, TickType_t timeout) {
+  return xQueueReceive(triggerQueue, &out, timeout) == pdTRUE;
+}
+
+bool mergePendingTriggers(RecordingEvent& event, uint32_t& latestSeq) {
+  bool merged = false;
+  Trigger t;
+  while (xQueueReceive(triggerQueue, &t, 0) == pdTRUE) {
+    event.add(t);
+    // 강제 녹음(captureHead)과 소음 감지(측정 구간 끝)는 순번 순서대로 들어오지 않으므로 가장 늦은 값을 고름
+    if (!merged || (int32_t)(t.seq - latestSeq) > 0) latestSeq = t.seq;
+    merged = true;
+  }
+  return merged;
+}
+
+void markRecordedUntil(uint32_t seq) {
+  recordedSeq = seq;
+  hasRecorded = true;
+}
+
+uint32_t recordedUntil() {
+  return hasRecorded ? recordedSeq : 0;
+}
+
+void eventMetadata(const RecordingEvent& event, uint32_t startSeq, JsonObject out) {
+  out["n"] = event.triggers;
+
+  JsonArray reasons = out["r"].to<JsonArray>();
+  if (event.reasons & TRIGGER_SOUND) reasons.add("sound");
+  if (event.reasons & TRIGGER_FORCED) reasons.add("forced");
+
+  JsonArray times = out["t"].to<JsonArray>();
+  int n = min(event.triggers, (int)RecordingEvent::MAX_TRIGGERS);
+  for (int i = 0; i < n; i++) {
+    // 큐에서 링 길이보다 오래 기다린 트리거는 녹음 시작(captureClamp로 당겨진 위치)보다 앞설 수 있음 → 0으로
+    int32_t offset = (int32_t)(event.seqs[i] - startSeq);
+    times.add((uint32_t)((uint64_t)max(offset, (int32_t)0) * 1000 / SAMPLE_RATE));
+  }
+}
+
+uint32_t droppedTriggers() {
+  return dropped;
+}
@@ -0,0 +1,58 @@
+// events.h
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "classifier.h"
+
+// 녹음 트리거 관리
+// 소음 감지/강제 녹음 요청은 큐에 쌓이고 Audio Task가 하나씩 꺼내 녹음합니다.
+// 녹음 중에 들어온 트리거는 새 녹음을 만들지 않고 진행 중인 녹음에 합쳐져 녹음을 연장합니다.
+enum TriggerReason : uint8_t {
+  TRIGGER_SOUND  = 1 << 0, // 소음 감지 (짖음/낑낑거림)
+  TRIGGER_FORCED = 1 << 1, // Nextion 버튼 등 강제 녹음
+};
+
+struct Trigger {
+  TriggerReason reason;
+  uint32_t seq;          // 트리거 시점의 캡처 순번
+  unsigned long at;      // millis
+  ClassifierResult cls;
+};
+
+// 녹음 하나에 합쳐진 트리거들
+struct RecordingEvent {
+  static const int MAX_TRIGGERS = 16; // 메타데이터에 개별 기록할 최대 트리거 수
+
+  Trigger first;
+  uint8_t reasons = 0;   // TriggerReason 비트 합
+  int triggers = 0;      // 합쳐진 트리거 수 (MAX_TRIGGERS 초과분 포함)
+  uint32_t seqs[MAX_TRIGGERS];
+
+  void add(const Trigger& t);
+};
+
+void setupEvents();
+
+// 트리거 등록. seq는 트리거를 판정한 캡처 순번 (소음 감지는 판정한 측정 구간의 끝, 강제 녹음은 captureHead())
+// 큐가 가득 차면 false (버려짐)
+bool postTrigger(TriggerReason reason, uint32_t seq, const ClassifierResult& cls);
+
+// 다음 트리거를 기다림 (Audio Task)
+bool waitTrigger(Trigger& out, TickType_t timeout);
+
+// 진행 중인 녹음에 대기 중인 트리거를 모두 합침. 새로 합쳐진 트리거 중 가장 늦은 순번을 latestSeq에 돌려줌
+bool mergePendingTriggers(RecordingEvent& event, uint32_t& latestSeq);
+
+// 녹음이 끝난 위치. 다음 녹음의 프리롤이 이전 녹음과 겹치지 않도록 사용
+void markRecordedUntil(uint32_t seq);
+uint32_t recordedUntil();
+
+// 업로드 메타데이터: {"n":트리거 수,"r":["sound","forced"],"t":[녹음 시작 기준 ms (녹음 시작 전 트리거는 0), ...]}
+void eventMetadata(const RecordingEvent& event, uint32_t startSeq, JsonObject out);
+
+uint32_t droppedTriggers();
+
+#endif
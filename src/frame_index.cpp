@@ -0,0 +1,59 @@
+// frame_index.cpp
+
+#include "frame_index.h"
+#include <stdlib.h>
+
+static void put16(uint8_t* p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t* p, uint32_t v) {
+  put16(p, v & 0xFFFF);
+  put16(p + 2, v >> 16);
+}
+
+static int16_t clamp16(int32_t v) {
+  if (v > INT16_MAX) return INT16_MAX;
+  if (v < INT16_MIN) return INT16_MIN;
+  return (int16_t)v;
+}
+
+bool FrameIndex::begin(size_t maxFrames, int samplesPerFrame) {
+  end();
+
+  capacity = HEADER_SIZE + maxFrames * RECORD_SIZE;
+  buffer = (uint8_t*)malloc(capacity);
+  if (!buffer) {
+    capacity = 0;
+    return false;
+  }
+
+  buffer[0] = 'P';
+  buffer[1] = 'I';
+  buffer[2] = 'D';
+  buffer[3] = 'X';
+  buffer[4] = VERSION;
+  buffer[5] = (uint8_t)(samplesPerFrame / 576); // 그래뉼 = 576 샘플
+  put16(buffer + 6, (uint16_t)samplesPerFrame);
+  length = HEADER_SIZE;
+  return true;
+}
+
+void FrameIndex::add(const shine_frame_info_t& info) {
+  if (!buffer || length + RECORD_SIZE > capacity) return;
+
+  uint8_t* rec = buffer + length;
+  put32(rec, (uint32_t)info.offset);
+  put16(rec + 4, (uint16_t)clamp16(info.energy[0]));
+  put16(rec + 6, (uint16_t)clamp16(info.energy[1]));
+  put16(rec + 8, (uint16_t)(info.peak >> 15));
+  length += RECORD_SIZE;
+}
+
+void FrameIndex::end() {
+  free(buffer);
+  buffer = nullptr;
+  capacity = 0;
+  length = 0;
+}
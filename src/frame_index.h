@@ -0,0 +1,49 @@
+// frame_index.h
+
+#ifndef FRAME_INDEX_H
+#define FRAME_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+extern "C" {
+  #include "layer3.h"
+}
+
+// MP3와 함께 업로드하는 프레임 인덱스(사이드카)
+// 서버가 디코딩 없이 탐색/썸네일(에너지 그래프)을 만들 수 있도록 프레임마다 고정 크기 레코드를 기록합니다.
+//
+// 형식 (리틀 엔디언)
+//   헤더 8바이트 : "PIDX" | 버전(u8) | 프레임당 그래뉼 수(u8) | 프레임당 샘플 수(u16)
+//   레코드 10바이트 : 바이트 오프셋(u32) | 그래뉼0 에너지(i16) | 그래뉼1 에너지(i16) | 피크(u16, xrmax >> 15)
+class FrameIndex {
+public:
+  static const uint8_t VERSION = 1;
+  static const size_t HEADER_SIZE = 8;
+  static const size_t RECORD_SIZE = 10;
+
+  FrameIndex() = default;
+  ~FrameIndex() { end(); }
+
+  FrameIndex(const FrameIndex&) = delete;
+  FrameIndex& operator=(const FrameIndex&) = delete;
+
+  // 최대 maxFrames개 프레임을 담을 버퍼를 할당. 실패 시 false
+  bool begin(size_t maxFrames, int samplesPerFrame);
+
+  // 프레임 하나 기록. 버퍼가 가득 차면 무시
+  void add(const shine_frame_info_t& info);
+
+  void end();
+
+  const uint8_t* data() const { return buffer; }
+  size_t size() const { return length; }
+  size_t frames() const { return length > HEADER_SIZE ? (length - HEADER_SIZE) / RECORD_SIZE : 0; }
+
+private:
+  uint8_t* buffer = nullptr;
+  size_t capacity = 0;
+  size_t length = 0;
+};
+
+#endif
@@ -0,0 +1,72 @@
+// level_meter.cpp
+
+#include "config.h"
+#include "level_meter.h"
+
+// 94 dB SPL에 해당하는 RMS(REFERENCE_RMS, 풀스케일 1.0 기준)를 16비트 정수 제곱 단위로 환산한 값의 dB
+//   dB = 94 + 10*log10(평균 제곱 / (REFERENCE_RMS * 32768)^2)
+static const float DB_OFFSET = 94.0f - 20.0f * log10f(REFERENCE_RMS * 32768.0f);
+
+// 샘플 제곱합. 4개씩 풀어서 누적 (|x| <= 32768 이므로 제곱은 int32에 들어감)
+static uint64_t sumSquares(const int16_t* pcm, size_t n) {
+  uint64_t acc = 0;
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    int32_t a = pcm[i], b = pcm[i + 1], c = pcm[i + 2], d = pcm[i + 3];
+    acc += (uint32_t)(a * a) + (uint32_t)(b * b);
+    acc += (uint32_t)(c * c) + (uint32_t)(d * d);
+  }
+  for (; i < n; i++) {
+    int32_t a = pcm[i];
+    acc += (uint32_t)(a * a);
+  }
+  return acc;
+}
+
+void LevelMeter::begin(uint32_t samples) {
+  windowSamples = samples > 0 ? samples : 1;
+  reset();
+}
+
+void LevelMeter::reset() {
+  count = 0;
+  sum = 0;
+  lastWindow = 0;
+  ready = false;
+  for (int i = 0; i < LONG_WINDOWS; i++) history[i] = 0;
+  historySum = 0;
+  historyPos = 0;
+  historyCount = 0;
+}
+
+size_t LevelMeter::feed(const int16_t* pcm, size_t n) {
+  ready = false;
+
+  size_t take = windowSamples - count;
+  if (take > n) take = n;
+  sum += sumSquares(pcm, take);
+  count += take;
+
+  if (count == windowSamples) {
+    lastWindow = sum;
+    historySum += sum - history[historyPos];
+    history[historyPos] = sum;
+    historyPos = (historyPos + 1) % LONG_WINDOWS;
+    if (historyCount < LONG_WINDOWS) historyCount++;
+
+    sum = 0;
+    count = 0;
+    ready = true;
+  }
+  return take;
+}
+
+float LevelMeter::longDb() const {
+  if (historyCount == 0) return 0;
+  return toDb(historySum, (uint32_t)historyCount * windowSamples);
+}
+
+float LevelMeter::toDb(uint64_t sumSquares, uint32_t count) {
+  if (sumSquares == 0 || count == 0) return 0;
+  return DB_OFFSET + 10.0f * log10f((float)sumSquares / count);
+}
@@ -0,0 +1,45 @@
+// level_meter.h
+
+#ifndef LEVEL_METER_H
+#define LEVEL_METER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 정수 누적 방식의 연속 소음 측정기 (동적 할당 없음)
+// 샘플 제곱을 int64로 더해 두고, 측정 구간(windowSamples)이 끝날 때만 dB로 변환합니다.
+//   단기 Leq : 직전 측정 구간 하나의 등가 소음도
+//   장기 Leq : 최근 LONG_WINDOWS개 측정 구간의 등가 소음도 (에너지 평균)
+class LevelMeter {
+public:
+  static const int LONG_WINDOWS = 50; // 200ms 구간 기준 10초
+
+  void begin(uint32_t windowSamples);
+  void reset();
+
+  // 현재 측정 구간이 끝날 때까지만 샘플을 소비하고 소비한 개수를 반환.
+  // 구간이 끝나면 windowReady()가 true가 되고, 다음 feed()에서 새 구간이 시작됨
+  size_t feed(const int16_t* pcm, size_t n);
+  bool windowReady() const { return ready; }
+
+  float shortDb() const { return toDb(lastWindow, windowSamples); }
+  float longDb() const;
+  uint64_t shortEnergy() const { return lastWindow; } // 직전 구간의 제곱합
+
+  // 제곱합(16비트 풀스케일 기준)을 dB SPL로 변환. 무음이면 0
+  static float toDb(uint64_t sumSquares, uint32_t count);
+
+private:
+  uint32_t windowSamples = 1;
+  uint32_t count = 0;
+  uint64_t sum = 0;
+  uint64_t lastWindow = 0;
+  bool ready = false;
+
+  uint64_t history[LONG_WINDOWS] = {};
+  uint64_t historySum = 0;
+  int historyPos = 0;
+  int historyCount = 0;
+};
+
+#endif
@@ -0,0 +1,173 @@
+// live.cpp
+
+#include "config.h"
+#include "live.h"
+#include "capture.h"
+#include "mp3_encoder.h"
+#include "metrics.h"
+#include <atomic>
+#include <memory>
+#include <esp_heap_caps.h>
+
+struct LiveSlot {
+  uint16_t len;
+  uint8_t data[LIVE_FRAME_MAX];
+};
+
+// 클라이언트별 읽기 위치
+struct LiveCursor {
+  uint32_t next; // 다음에 보낼 프레임 번호
+};
+
+static LiveSlot* frames = NULL;
+static std::atomic<uint32_t> frameHead(0); // 지금까지 링에 넣은 프레임 수
+static std::atomic<uint32_t> clients(0);
+static std::atomic<uint32_t> dropped(0);
+static TaskHandle_t liveTaskHandle = NULL;
+
+static Counter frameCounter("pet_mp3_frames_total", "MP3 frames encoded", "enc=\"live\"",
+                            []() -> uint32_t { return frameHead.load(); });
+static Gauge clientGauge("pet_live_clients", "Connected /live listeners", nullptr,
+                         []() -> int32_t { return clients.load(); });
+static Counter droppedCounter("pet_live_dropped_frames_total", "Frames skipped for listeners that fell behind", nullptr,
+                              []() -> uint32_t { return dropped.load(); });
+
+// 프레임을 링에 넣고 공개 (기록 후 head 증가, 클라이언트는 head 미만만 읽음)
+static void publishFrame(const Mp3Frame& frame) {
+  if (frame.len == 0 || frame.len > LIVE_FRAME_MAX) return;
+  uint32_t n = frameHead.load(std::memory_order_relaxed);
+  LiveSlot& slot = frames[n % LIVE_RING_FRAMES];
+  memcpy(slot.data, frame.data, frame.len);
+  slot.len = (uint16_t)frame.len;
+  frameHead.store(n + 1, std::memory_order_release);
+}
+
+// 인코더 Task: 청취자가 있을 때만 캡처 링을 읽어 인코딩 (녹음과 같은 캡처를 공유, I2S는 캡처 Task만 읽음)
+static void live_task_function(void *pvParameters) {
+  Mp3Encoder encoder;
+  for (;;) {
+    if (clients.load() == 0) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // 첫 청취자가 접속할 때까지 대기
+      continue;
+    }
+
+    if (!encoder.begin(SAMPLE_RATE, MP3_BITRATE, nullptr)) {
+      D_PRINTLN("라이브 인코더 초기화 실패!");
+      vTaskDelay(pdMS_TO_TICKS(1000));
+      continue;
+    }
+    encoder.setLowLatency(true); // 비트 저장소 없이 프레임마다 완결 → 어느 프레임부터 들어도 재생 가능
+    D_PRINTLN("라이브 인코더 시작.");
+
+    CaptureReader reader;
+    captureReaderBegin(reader, captureHead());
+    while (clients.load() > 0) {
+      const int16_t* pcm;
+      size_t n = captureAcquire(reader, &pcm, CAPTURE_BLOCK_SAMPLES);
+      if (n == 0) {
+        captureWait(reader, pdMS_TO_TICKS(100));
+        continue;
+      }
+
+      // 완성되는 프레임을 하나씩 꺼내 링에 넣음 (콜백/추가 복사 없음)
+      const int16_t* p = pcm;
+      size_t left = n;
+      Mp3Frame frame;
+      while (encoder.pull(p, left, frame)) {
+        publishFrame(frame);
+      }
+      captureRelease(reader, n);
+    }
+
+    encoder.end();
+    D_PRINTF("라이브 인코더 정지. (캡처 건너뜀 %u 샘플)\n", (unsigned)reader.dropped);
+  }
+}
+
+// 클라이언트 전송 버퍼를 다음 프레임들로 채움. 프레임은 쪼개지 않고 통째로만 보냄
+static size_t fillFrames(LiveCursor& cursor, uint8_t* buffer, size_t maxLen) {
+  uint32_t head = frameHead.load(std::memory_order_acquire);
+
+  // 링 한 바퀴 가까이 밀렸으면 최신 프레임 근처로 건너뜀 (인코더는 기다리지 않음)
+  if (head - cursor.next >= (uint32_t)LIVE_RING_FRAMES - 2) {
+    uint32_t resume = head - 2;
+    dropped.fetch_add(resume - cursor.next, std::memory_order_relaxed);
+    cursor.next = resume;
+  }
+
+  size_t out = 0;
+  while (cursor.next != head) {
+    const LiveSlot& slot = frames[cursor.next % LIVE_RING_FRAMES];
+    size_t len = slot.len;
+    if (out + len > maxLen) break;
+    memcpy(buffer + out, slot.data, len);
+
+    // 복사하는 동안 인코더가 이 슬롯을 덮어썼다면 버림
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (frameHead.load(std::memory_order_relaxed) - cursor.next >= (uint32_t)LIVE_RING_FRAMES) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      cursor.next++;
+      continue;
+    }
+    out += len;
+    cursor.next++;
+  }
+
+  // 보낼 프레임이 없으면 연결을 유지한 채 나중에 다시 호출됨
+  return out > 0 ? out : RESPONSE_TRY_AGAIN;
+}
+
+bool setupLive() {
+  frames = (LiveSlot*)heap_caps_malloc(LIVE_RING_FRAMES * sizeof(LiveSlot), MALLOC_CAP_SPIRAM);
+  if (!frames) {
+    D_PRINTLN("라이브 프레임 링(PSRAM) 할당 실패!");
+    return false;
+  }
+
+  xTaskCreatePinnedToCore(
+      live_task_function,     // Task 함수
+      "Live Task",            // Task 이름
+      8192,                   // Stack 크기
+      NULL,                   // Task 파라미터
+      1,                      // 우선순위
+      &liveTaskHandle,        // Task 핸들
+      1);                     // Core 1에서 실행
+  return true;
+}
+
+void handleLiveRequest(AsyncWebServerRequest *request) {
+  D_PRINTLN("--- GET /live 요청 수신 ---");
+  if (!frames) {
+    request->send(503, "text/plain", "Live stream unavailable");
+    return;
+  }
+  if (clients.fetch_add(1) >= (uint32_t)LIVE_MAX_CLIENTS) {
+    clients.fetch_sub(1);
+    request->send(503, "text/plain", "Too many listeners");
+    return;
+  }
+  xTaskNotifyGive(liveTaskHandle);
+
+  // 다음에 인코딩되는 프레임부터 전송 (링에 남은 프레임은 인코더가 쉬기 전의 오래된 소리일 수 있음)
+  auto cursor = std::make_shared<LiveCursor>();
+  cursor->next = frameHead.load(std::memory_order_acquire);
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse("audio/mpeg",
+    [cursor](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      return fillFrames(*cursor, buffer, maxLen);
+    });
+  response->addHeader("Cache-Control", "no-cache");
+  request->onDisconnect([]() {
+    clients.fetch_sub(1);
+    D_PRINTLN("라이브 청취자 연결 종료.");
+  });
+  request->send(response);
+}
+
+LiveStats liveStats() {
+  LiveStats s;
+  s.clients = clients.load();
+  s.frames = frameHead.load();
+  s.dropped = dropped.load();
+  return s;
+}
@@ -0,0 +1,29 @@
+// live.h
+
+#ifndef LIVE_H
+#define LIVE_H
+
+#include <stdint.h>
+
+class AsyncWebServerRequest;
+
+// 실시간 MP3 스트리밍 (GET /live)
+// 청취자가 있는 동안만 저지연 모드 인코더가 캡처 링을 읽어 프레임 링에 MP3 프레임을 쌓고,
+// 각 클라이언트는 자기 위치(cursor)에서 chunked 응답으로 프레임을 받아 갑니다.
+// 저지연 모드 프레임은 서로 독립적이므로, 느린 클라이언트는 인코더를 막지 않고 프레임 단위로 건너뜁니다.
+
+struct LiveStats {
+  uint32_t clients;
+  uint32_t frames;  // 인코딩한 프레임 수
+  uint32_t dropped; // 클라이언트가 따라오지 못해 건너뛴 프레임 수 (전체 합)
+};
+
+// 프레임 링 할당 및 인코더 Task 생성 (캡처 시작 후 호출)
+bool setupLive();
+
+// GET /live 요청 처리
+void handleLiveRequest(AsyncWebServerRequest *request);
+
+LiveStats liveStats();
+
+#endif
@@ -3,13 +3,17 @@
 #include "sensors.h"
 #include "audio.h"
 #include "display.h"
+#include "events.h"
+#include "telemetry.h"
+#include "control.h"
 
 // ==========================================================
 //      config.h에 선언된 전역 변수들의 실제 값을 여기서 정의합니다.
 // ==========================================================
 const char* upload_server       = "192.168.219.106"; // 사용하시던 서버 주소로 변경하세요
 const int   upload_port         = 8080;
-const char* upload_sensor_path  = "/FarmData/api/datainput.do";
+const char* upload_telemetry_path = "/FarmData/api/datainputs.do"; // 센서 데이터 묶음 (telemetry.h). 서버에 추가 필요
+const char* upload_sensor_path  = "/FarmData/api/datainput.do";  // 기존 샘플별 업로드, 묶음 엔드포인트가 없을 때 사용
 const char* upload_file_path    = "/FarmData/fileUpload.do";
 const char* device_id           = "TEST_MACHINE";
 const char* ntpServer           = "pool.ntp.org";
@@ -28,7 +32,6 @@ AsyncWebServer server(80); // server 객체 생성 80번
 DeviceState deviceState;
 
 // FreeRTOS 핸들 정의
-SemaphoreHandle_t audioSemaphore;
 TaskHandle_t audioTaskHandle;
 
 // 오디오 버퍼
@@ -48,7 +51,7 @@ void setup() {
   setupSensors();
   
   // 오디오 Task 생성
-  audioSemaphore = xSemaphoreCreateBinary();
+  setupEvents(); // 트리거 큐
   xTaskCreatePinnedToCore(
       audio_task_function,    // Task 함수
       "Audio Task",           // Task 이름
@@ -60,6 +63,7 @@ void setup() {
 
   setupWiFi();
   setupWebServer();
+  setupTelemetry();
   setupAudio();
 
   D_PRINTLN("--- 모든 설정 완료. 오디오 안정화 대기 중... ---");
@@ -72,4 +76,5 @@ void loop() {
   myNex.NextionListen();
   handleSensorAndDisplayUpdates();
   handleSoundCheck();
+  handleControl();
 }
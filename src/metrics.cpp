@@ -0,0 +1,112 @@
+// metrics.cpp
+
+#include "metrics.h"
+#include <string.h>
+
+// 정적 초기화 중에 등록되므로 상수 초기화되는 포인터만 사용
+static Metric* head = nullptr;
+static Metric* tail = nullptr;
+
+const uint32_t HANDLER_US_BOUNDS[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000};
+const size_t HANDLER_US_BOUNDS_COUNT = sizeof(HANDLER_US_BOUNDS) / sizeof(HANDLER_US_BOUNDS[0]);
+const uint32_t DURATION_MS_BOUNDS[] = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000};
+const size_t DURATION_MS_BOUNDS_COUNT = sizeof(DURATION_MS_BOUNDS) / sizeof(DURATION_MS_BOUNDS[0]);
+
+// 시스템 전체 지표
+static Gauge heapFree("pet_heap_free_bytes", "Free internal heap", nullptr,
+                      []() -> int32_t { return ESP.getFreeHeap(); });
+static Gauge heapMin("pet_heap_min_free_bytes", "Lowest free internal heap since boot", nullptr,
+                     []() -> int32_t { return ESP.getMinFreeHeap(); });
+static Gauge psramFree("pet_psram_free_bytes", "Free PSRAM", nullptr,
+                       []() -> int32_t { return ESP.getFreePsram(); });
+static Gauge uptime("pet_uptime_seconds", "Seconds since boot", nullptr,
+                    []() -> int32_t { return millis() / 1000; });
+
+Metric::Metric(const char* name, const char* help, const char* labels, const char* type)
+  : name(name), help(help), labels(labels), type(type), next(nullptr) {
+  // 등록 순서대로 출력
+  if (tail) {
+    tail->next = this;
+  } else {
+    head = this;
+  }
+  tail = this;
+}
+
+void Metric::writeLabels(Print& out, const char* extra) const {
+  if (!labels && !extra) return;
+  out.print('{');
+  if (labels) out.print(labels);
+  if (labels && extra) out.print(',');
+  if (extra) out.print(extra);
+  out.print('}');
+}
+
+void Metric::writeAll(Print& out) {
+  // 같은 이름의 지표는 처음 나온 자리에서 HELP/TYPE과 함께 한 번에 출력
+  for (Metric* m = head; m; m = m->next) {
+    bool seen = false;
+    for (Metric* p = head; p != m; p = p->next) {
+      if (strcmp(p->name, m->name) == 0) {
+        seen = true;
+        break;
+      }
+    }
+    if (seen) continue;
+
+    out.printf("# HELP %s %s\n# TYPE %s %s\n", m->name, m->help, m->name, m->type);
+    for (Metric* s = m; s; s = s->next) {
+      if (strcmp(s->name, m->name) == 0) s->writeSamples(out);
+    }
+  }
+}
+
+void Counter::writeSamples(Print& out) const {
+  out.print(name);
+  writeLabels(out);
+  out.printf(" %lu\n", (unsigned long)(read ? read() : value.load(std::memory_order_relaxed)));
+}
+
+void Gauge::writeSamples(Print& out) const {
+  out.print(name);
+  writeLabels(out);
+  out.printf(" %ld\n", (long)(read ? read() : value.load(std::memory_order_relaxed)));
+}
+
+Histogram::Histogram(const char* name, const char* help, const char* labels, const uint32_t* bounds, size_t count)
+  : Metric(name, help, labels, "histogram"), bounds(bounds), count(count < MAX_BUCKETS ? count : MAX_BUCKETS) {
+  for (size_t i = 0; i <= MAX_BUCKETS; i++) buckets[i].store(0, std::memory_order_relaxed);
+}
+
+void Histogram::observe(uint32_t v) {
+  size_t i = 0;
+  while (i < count && v > bounds[i]) i++;
+  buckets[i].fetch_add(1, std::memory_order_relaxed);
+  sum.fetch_add(v, std::memory_order_relaxed);
+}
+
+void Histogram::writeSamples(Print& out) const {
+  // 구간별 개수를 누적해 le(이하) 형식으로
+  char le[24];
+  uint32_t cumulative = 0;
+  for (size_t i = 0; i <= count; i++) {
+    cumulative += buckets[i].load(std::memory_order_relaxed);
+    if (i < count) {
+      snprintf(le, sizeof(le), "le=\"%lu\"", (unsigned long)bounds[i]);
+    } else {
+      strcpy(le, "le=\"+Inf\"");
+    }
+    out.print(name);
+    out.print("_bucket");
+    writeLabels(out, le);
+    out.printf(" %lu\n", (unsigned long)cumulative);
+  }
+  out.print(name);
+  out.print("_sum");
+  writeLabels(out);
+  out.printf(" %lu\n", (unsigned long)sum.load(std::memory_order_relaxed));
+  out.print(name);
+  out.print("_count");
+  writeLabels(out);
+  out.printf(" %lu\n", (unsigned long)cumulative);
+}
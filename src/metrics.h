@@ -0,0 +1,114 @@
+// metrics.h
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// 계측 레지스트리 (GET /metrics, Prometheus 텍스트 형식)
+// 각 모듈은 파일 범위 전역으로 지표를 정의하기만 하면 생성자에서 레지스트리에 등록됩니다.
+// 값 갱신은 std::atomic만 사용하므로 어느 Task, 어느 코어에서든 락 없이 호출할 수 있습니다.
+// 이미 다른 모듈이 세고 있는 값(스풀 통계, 캡처 오버런, 힙 등)은 읽기 함수를 넘겨 출력할 때 읽습니다.
+//
+// 이름은 pet_ 접두사를 붙이고, 같은 이름에 라벨만 다른 지표(예: path="/status")는 한 묶음으로 출력됩니다.
+// labels는 `path="/status"`처럼 따옴표를 포함한 Prometheus 라벨 목록 (없으면 nullptr)
+
+class Metric {
+public:
+  Metric(const Metric&) = delete;
+  Metric& operator=(const Metric&) = delete;
+
+  // 등록된 모든 지표를 Prometheus 텍스트 형식으로 출력
+  static void writeAll(Print& out);
+
+protected:
+  Metric(const char* name, const char* help, const char* labels, const char* type);
+
+  // 라벨 목록 출력: {labels} 또는 {labels,extra}. 둘 다 없으면 출력 안 함
+  void writeLabels(Print& out, const char* extra = nullptr) const;
+  virtual void writeSamples(Print& out) const = 0;
+
+  const char* name;
+  const char* help;
+  const char* labels;
+  const char* type;
+
+private:
+  Metric* next;
+};
+
+// 계속 증가하는 값
+class Counter : public Metric {
+public:
+  Counter(const char* name, const char* help, const char* labels = nullptr)
+    : Metric(name, help, labels, "counter") {}
+  // 다른 모듈이 이미 세고 있는 값을 출력할 때 읽음
+  Counter(const char* name, const char* help, const char* labels, uint32_t (*read)())
+    : Metric(name, help, labels, "counter"), read(read) {}
+
+  void inc(uint32_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+
+protected:
+  void writeSamples(Print& out) const override;
+
+private:
+  std::atomic<uint32_t> value{0};
+  uint32_t (*read)() = nullptr;
+};
+
+// 오르내리는 현재 값
+class Gauge : public Metric {
+public:
+  Gauge(const char* name, const char* help, const char* labels = nullptr)
+    : Metric(name, help, labels, "gauge") {}
+  Gauge(const char* name, const char* help, const char* labels, int32_t (*read)())
+    : Metric(name, help, labels, "gauge"), read(read) {}
+
+  void set(int32_t v) { value.store(v, std::memory_order_relaxed); }
+
+protected:
+  void writeSamples(Print& out) const override;
+
+private:
+  std::atomic<int32_t> value{0};
+  int32_t (*read)() = nullptr;
+};
+
+// 고정 구간 히스토그램. bounds는 오름차순 상한 목록 (정적 배열, 최대 MAX_BUCKETS개)
+class Histogram : public Metric {
+public:
+  static const size_t MAX_BUCKETS = 16;
+
+  Histogram(const char* name, const char* help, const char* labels, const uint32_t* bounds, size_t count);
+
+  void observe(uint32_t v);
+
+protected:
+  void writeSamples(Print& out) const override;
+
+private:
+  const uint32_t* bounds;
+  size_t count;
+  std::atomic<uint32_t> buckets[MAX_BUCKETS + 1]; // 마지막은 +Inf
+  std::atomic<uint32_t> sum{0}; // 32비트에서 넘치면 0부터 다시 (Prometheus는 카운터 리셋으로 처리)
+};
+
+// 자주 쓰는 구간
+extern const uint32_t HANDLER_US_BOUNDS[]; // HTTP 핸들러 실행 시간 (µs)
+extern const size_t HANDLER_US_BOUNDS_COUNT;
+extern const uint32_t DURATION_MS_BOUNDS[]; // 업로드/녹음 시간 (ms)
+extern const size_t DURATION_MS_BOUNDS_COUNT;
+
+// 구간 하나의 실행 시간을 µs로 잼 (소멸 시 기록)
+class ScopedTimerUs {
+public:
+  explicit ScopedTimerUs(Histogram& h) : histogram(h), start(micros()) {}
+  ~ScopedTimerUs() { histogram.observe(micros() - start); }
+
+private:
+  Histogram& histogram;
+  uint32_t start;
+};
+
+#endif
@@ -0,0 +1,94 @@
+// mp3_encoder.cpp
+
+#include "mp3_encoder.h"
+
+bool Mp3Encoder::begin(int sampleRate, int bitrate, FrameSink frameSink) {
+  end();
+
+  shine_config_t config;
+  shine_set_config_mpeg_defaults(&config.mpeg);
+  config.wave.samplerate = sampleRate;
+  config.wave.channels = PCM_MONO;
+  config.mpeg.bitr = bitrate;
+  config.mpeg.mode = MONO;
+
+  if (shine_check_config(config.wave.samplerate, config.mpeg.bitr) < 0) {
+    return false;
+  }
+
+  sink = frameSink;
+  frameInfoSink = nullptr;
+  this->sampleRate = sampleRate;
+  stream = shine_stream_open(&config, onEncoded, this);
+  return stream != NULL;
+}
+
+void Mp3Encoder::onFrame(FrameInfoSink infoSink) {
+  frameInfoSink = infoSink;
+  if (stream) {
+    shine_stream_on_frame(stream, frameInfoSink ? onFrameInfo : NULL);
+  }
+}
+
+int Mp3Encoder::write(const int16_t* pcm, size_t samples) {
+  if (!stream) return 0;
+  return shine_stream_write(stream, pcm, (int)samples);
+}
+
+void Mp3Encoder::setLowLatency(bool enable) {
+  if (stream) {
+    shine_set_low_latency(shine_stream_encoder(stream), enable ? 1 : 0);
+  }
+}
+
+bool Mp3Encoder::pull(const int16_t*& pcm, size_t& samples, Mp3Frame& out) {
+  if (!stream) return false;
+
+  int remaining = (int)samples;
+  shine_stream_frame_t frame;
+  int got = shine_stream_pull(stream, &pcm, &remaining, &frame);
+  samples = (size_t)remaining;
+  if (!got) return false;
+
+  out.data = frame.data;
+  out.len = (size_t)frame.len;
+  out.timestampMs = (uint32_t)((int64_t)frame.pts * 1000 / sampleRate);
+  out.info = frame.info;
+  return true;
+}
+
+int Mp3Encoder::finish() {
+  if (!stream) return 0;
+  return shine_stream_flush(stream);
+}
+
+void Mp3Encoder::end() {
+  if (stream) {
+    shine_stream_close(stream);
+    stream = NULL;
+  }
+}
+
+int Mp3Encoder::samplesPerFrame() const {
+  return stream ? shine_stream_samples_per_pass(stream) : 0;
+}
+
+bool Mp3Encoder::footprint(shine_footprint_t* out) const {
+  if (!stream) return false;
+  shine_stream_get_footprint(stream, out);
+  return true;
+}
+
+void Mp3Encoder::onEncoded(const unsigned char* data, int len, void* user) {
+  Mp3Encoder* self = static_cast<Mp3Encoder*>(user);
+  if (self->sink) {
+    self->sink(data, (size_t)len);
+  }
+}
+
+void Mp3Encoder::onFrameInfo(const shine_frame_info_t* info, void* user) {
+  Mp3Encoder* self = static_cast<Mp3Encoder*>(user);
+  if (self->frameInfoSink) {
+    self->frameInfoSink(*info);
+  }
+}
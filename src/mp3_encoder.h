@@ -0,0 +1,73 @@
+// mp3_encoder.h
+
+#ifndef MP3_ENCODER_H
+#define MP3_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+
+extern "C" {
+  #include "l3stream.h"
+}
+
+// pull()로 꺼낸 MP3 프레임 하나. data는 다음 인코더 호출 전까지만 유효
+struct Mp3Frame {
+  const uint8_t* data;
+  size_t len;
+  uint32_t timestampMs; // 프레임 첫 샘플의 위치 (인코더 시작 기준)
+  shine_frame_info_t info;
+};
+
+// Shine 스트림 인코더를 감싸는 RAII 클래스
+// 임의 길이의 PCM 조각을 받아 프레임이 찰 때마다 인코딩하고, 결과를 sink 콜백으로 넘겨줍니다.
+class Mp3Encoder {
+public:
+  using FrameSink = std::function<void(const uint8_t* data, size_t len)>;
+  using FrameInfoSink = std::function<void(const shine_frame_info_t& info)>;
+
+  Mp3Encoder() = default;
+  ~Mp3Encoder() { end(); }
+
+  Mp3Encoder(const Mp3Encoder&) = delete;
+  Mp3Encoder& operator=(const Mp3Encoder&) = delete;
+
+  // 모노 인코더를 연다. 지원되지 않는 설정이거나 메모리가 부족하면 false
+  bool begin(int sampleRate, int bitrate, FrameSink sink);
+
+  // 프레임마다 분석 값(오프셋, 그래뉼 에너지, 피크)을 받을 콜백. begin() 이후에 설정
+  void onFrame(FrameInfoSink infoSink);
+
+  // 길이 제한 없이 PCM 샘플을 넣는다. 인코딩된 프레임 수를 반환
+  int write(const int16_t* pcm, size_t samples);
+
+  // 저지연 모드: 비트 저장소를 끄고 프레임 하나를 온전히 바로 내보냄 (라이브 스트리밍용)
+  void setLowLatency(bool enable);
+
+  // pull 방식: pcm/samples를 소비하다가 프레임 하나가 완성되면 out을 채우고 true.
+  // 입력을 다 쓰면 false (남은 샘플은 다음 호출까지 보관). sink 콜백은 호출되지 않음
+  bool pull(const int16_t*& pcm, size_t& samples, Mp3Frame& out);
+
+  // 마지막 미완성 프레임을 무음으로 채워 인코딩하고 남은 데이터를 모두 내보낸다
+  int finish();
+
+  // 인코더를 닫는다 (소멸자에서도 호출됨)
+  void end();
+
+  bool isOpen() const { return stream != NULL; }
+  int samplesPerFrame() const;
+
+  // 인코더가 사용 중인 메모리 (구성 요소별 바이트, 비트스트림 버퍼 최대 사용량, 스트림 PCM 버퍼 포함)
+  bool footprint(shine_footprint_t* out) const;
+
+private:
+  static void onEncoded(const unsigned char* data, int len, void* user);
+  static void onFrameInfo(const shine_frame_info_t* info, void* user);
+
+  shine_stream_t stream = NULL;
+  FrameSink sink;
+  FrameInfoSink frameInfoSink;
+  int sampleRate = 0;
+};
+
+#endif
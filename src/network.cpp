@@ -3,8 +3,16 @@
 #include "config.h"
 #include "display.h" // Nextion 화면 제어를 위해 포함
 #include "network.h"
+#include "classifier.h" // GET /classifier
+#include "live.h"       // GET /live
+#include "telemetry.h"  // GET /telemetry
+#include "sensors.h"    // 센서 스냅샷
+#include "control.h"    // 팬/히터 제어, 상태 버전
+#include "push.h"       // GET /events
+#include "metrics.h"    // GET /metrics
 #include <Preferences.h>
 #include <ESPmDNS.h>
+#include <atomic>
 
 // --- [수정] 고정 IP 설정을 위한 정보 ---
 // 사용자의 네트워크 환경에 맞게 이 값들을 수정해야 합니다.
@@ -83,77 +91,490 @@ void setupWiFi() {
 
 
   configTime(gmtOffset_sec, daylightOffset_sec, ntpServer);
+
+  uplink.begin();
+}
+
+// ------------------ 계측 -----------------
+// 핸들러 실행 시간 (async_tcp Task를 얼마나 붙잡는지). 요청 수는 _count로 알 수 있음
+#define HANDLER_HISTOGRAM(var, route) \
+  static Histogram var("pet_http_handler_us", "HTTP handler run time in microseconds", route, \
+                       HANDLER_US_BOUNDS, HANDLER_US_BOUNDS_COUNT)
+HANDLER_HISTOGRAM(statusGetUs, "path=\"/status\",method=\"GET\"");
+HANDLER_HISTOGRAM(statusPostUs, "path=\"/status\",method=\"POST\"");
+HANDLER_HISTOGRAM(commandsUs, "path=\"/commands\",method=\"POST\"");
+HANDLER_HISTOGRAM(sensorsUs, "path=\"/sensors\",method=\"GET\"");
+HANDLER_HISTOGRAM(classifierUs, "path=\"/classifier\",method=\"GET\"");
+HANDLER_HISTOGRAM(uplinkUs, "path=\"/uplink\",method=\"GET\"");
+HANDLER_HISTOGRAM(telemetryUs, "path=\"/telemetry\",method=\"GET\"");
+HANDLER_HISTOGRAM(metricsUs, "path=\"/metrics\",method=\"GET\"");
+
+static Histogram uplinkNewMs("pet_uplink_request_ms", "Upload request time in milliseconds, including connect",
+                             "conn=\"new\"", DURATION_MS_BOUNDS, DURATION_MS_BOUNDS_COUNT);
+static Histogram uplinkReusedMs("pet_uplink_request_ms", "Upload request time in milliseconds, including connect",
+                                "conn=\"reused\"", DURATION_MS_BOUNDS, DURATION_MS_BOUNDS_COUNT);
+static Counter uplinkFailures("pet_uplink_failures_total", "Upload connections or requests that failed", nullptr,
+                              []() -> uint32_t { return uplink.stats().failures; });
+static Counter uplinkConnects("pet_uplink_connects_total", "New TCP connections to the upload server", nullptr,
+                              []() -> uint32_t { return uplink.stats().connects; });
+static Counter uplinkStale("pet_uplink_stale_total", "Reused connections found closed and reopened", nullptr,
+                           []() -> uint32_t { return uplink.stats().stale; });
+
+// ------------------ 응답 형식 협상 (JSON / MessagePack) -----------------
+// Accept에 application/msgpack이 있으면 MessagePack으로 응답. MessagePack에서는 소수점 값을
+// 문자열 대신 10^자릿수 배 정수로 보냄 (예: 온도 25.3 -> 253)
+static const char* MSGPACK_TYPE = "application/msgpack";
+
+static bool wantsMsgPack(AsyncWebServerRequest *request) {
+  if (!request->hasHeader("Accept")) return false;
+  return request->getHeader("Accept")->value().indexOf("msgpack") >= 0;
+}
+
+static bool isMsgPackBody(AsyncWebServerRequest *request) {
+  return request->contentType().indexOf("msgpack") >= 0;
+}
+
+static void putFixed(JsonObject obj, const char* key, float value, int digits, bool msgpack) {
+  static const float SCALE[] = {1, 10, 100, 1000};
+  if (msgpack) {
+    obj[key] = lroundf(value * SCALE[digits]);
+  } else {
+    obj[key] = String(value, digits);
+  }
+}
+
+// ------------------ 조건부 요청 (ETag / Last-Modified) -----------------
+// 상태/센서 버전으로 ETag를 만들고, If-None-Match(또는 If-Modified-Since)가 일치하면
+// ArduinoJson을 거치지 않고 본문 없는 304로 응답합니다.
+// 재부팅 후 버전이 다시 1부터 시작해도 이전 ETag와 겹치지 않도록 부팅마다 다른 값을 섞음
+static uint32_t bootId = 0;
+
+struct Validators {
+  char etag[32];
+  char lastModified[32]; // 시간 동기화 전이면 빈 문자열
+};
+
+static void makeValidators(Validators& v, char kind, uint32_t version, time_t changedAt, bool msgpack) {
+  // 형식마다 본문이 다르므로 ETag도 구분
+  snprintf(v.etag, sizeof(v.etag), "\"%c%08lx.%lu%s\"", kind, (unsigned long)bootId,
+           (unsigned long)version, msgpack ? "m" : "");
+  v.lastModified[0] = '\0';
+  if (changedAt) {
+    struct tm tm;
+    gmtime_r(&changedAt, &tm);
+    strftime(v.lastModified, sizeof(v.lastModified), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+  }
+}
+
+static void addValidators(AsyncWebServerResponse *response, const Validators* v) {
+  if (!v) return;
+  response->addHeader("ETag", v->etag);
+  if (v->lastModified[0]) response->addHeader("Last-Modified", v->lastModified);
+  response->addHeader("Cache-Control", "no-cache"); // 캐시해도 되지만 매번 재검증
+}
+
+// 클라이언트가 가진 것이 최신이면 304를 보내고 true
+static bool sendNotModified(AsyncWebServerRequest *request, const Validators& v) {
+  bool fresh;
+  if (request->hasHeader("If-None-Match")) {
+    const String& tags = request->getHeader("If-None-Match")->value();
+    fresh = strstr(tags.c_str(), v.etag) != NULL || tags == "*";
+  } else if (v.lastModified[0] && request->hasHeader("If-Modified-Since")) {
+    // 우리가 보낸 Last-Modified를 그대로 돌려받는 경우만 처리
+    fresh = request->getHeader("If-Modified-Since")->value() == v.lastModified;
+  } else {
+    return false;
+  }
+  if (!fresh) return false;
+
+  AsyncWebServerResponse *response = request->beginResponse(304);
+  response->addHeader("Vary", "Accept");
+  addValidators(response, &v);
+  request->send(response);
+  return true;
+}
+
+static void sendDocument(AsyncWebServerRequest *request, const JsonDocument& doc, bool msgpack,
+                         const Validators* validators = nullptr, int code = 200) {
+  AsyncResponseStream *response = request->beginResponseStream(msgpack ? MSGPACK_TYPE : "application/json");
+  response->setCode(code);
+  response->addHeader("Vary", "Accept");
+  addValidators(response, validators);
+  if (msgpack) {
+    serializeMsgPack(doc, *response);
+  } else {
+    serializeJson(doc, *response);
+  }
+  request->send(response);
+}
+
+// ------------------ 힙 할당 없는 작은 JSON 응답 -----------------
+// 대시보드가 자주 폴링하는 /status, /sensors는 JsonDocument/String 없이 미리 잡아 둔 슬롯에 본문을 바로 쓰고,
+// 응답이 끝나 연결이 닫힐 때까지 슬롯을 빌려 줍니다. 슬롯이 모두 사용 중이면 기존 경로로 응답합니다.
+static const int REPLY_SLOTS = 8;
+static const size_t REPLY_SIZE = 96;
+
+struct ReplySlot {
+  std::atomic<bool> used;
+  size_t len;
+  char body[REPLY_SIZE];
+};
+static ReplySlot replySlots[REPLY_SLOTS];
+static const String JSON_TYPE("application/json");
+
+static ReplySlot* acquireReply() {
+  for (int i = 0; i < REPLY_SLOTS; i++) {
+    bool expected = false;
+    if (replySlots[i].used.compare_exchange_strong(expected, true)) return &replySlots[i];
+  }
+  return nullptr;
+}
+
+// 슬롯 내용을 그대로 응답 버퍼에 복사 (람다는 포인터 하나만 캡처하므로 std::function도 할당하지 않음)
+static void sendReply(AsyncWebServerRequest *request, ReplySlot* slot, const Validators* validators) {
+  AsyncWebServerResponse *response = request->beginResponse(JSON_TYPE, slot->len,
+    [slot](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      size_t n = min(maxLen, slot->len - index);
+      memcpy(buffer, slot->body + index, n);
+      return n;
+    });
+  response->addHeader("Vary", "Accept");
+  addValidators(response, validators);
+  request->onDisconnect([slot]() { slot->used = false; });
+  request->send(response);
+}
+
+// 0.1 단위 정수를 "25.3" 형식으로
+static int formatTenths(char* out, size_t size, int32_t tenths) {
+  uint32_t a = tenths < 0 ? -tenths : tenths;
+  return snprintf(out, size, "%s%lu.%lu", tenths < 0 ? "-" : "", (unsigned long)(a / 10), (unsigned long)(a % 10));
+}
+
+static void formatStatusReply(ReplySlot* slot) {
+  slot->len = snprintf(slot->body, REPLY_SIZE, "{\"f\":%s,\"ht\":%s}",
+                       deviceState.isFanOn ? "true" : "false", deviceState.isHeaterOn ? "true" : "false");
+}
+
+// 기존 JSON과 같은 모양 {"t":"25.3","h":"40.0","c":"412"}
+static void formatSensorsReply(ReplySlot* slot, float temp, float humi, float co2) {
+  char t[12], h[12];
+  formatTenths(t, sizeof(t), lroundf(temp * 10));
+  formatTenths(h, sizeof(h), lroundf(humi * 10));
+  slot->len = snprintf(slot->body, REPLY_SIZE, "{\"t\":\"%s\",\"h\":\"%s\",\"c\":\"%ld\"}", t, h, lroundf(co2));
+}
+
+// ------------------ 요청 본문 모으기 -----------------
+// 본문이 여러 TCP 세그먼트로 나뉘어 와도 _tempObject(요청이 끝나면 라이브러리가 free)에 모았다가,
+// 본문을 다 받은 뒤 호출되는 요청 핸들러에서 한 번만 처리합니다.
+// maxSize를 넘는 본문은 첫 조각에서 바로 413으로 거절하고 나머지는 버립니다.
+static void collectBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total,
+                        size_t maxSize) {
+  if (index == 0) {
+    if (total > maxSize) {
+      D_PRINTF("요청 본문이 너무 큽니다: %u bytes\n", (unsigned)total);
+      request->send(413, "text/plain", "Payload Too Large");
+      return;
+    }
+    request->_tempObject = malloc(total);
+  }
+  if (!request->_tempObject || index + len > total) return;
+  memcpy((uint8_t *)request->_tempObject + index, data, len);
+}
+
+// 모은 본문 (길이는 request->contentLength()). 이미 413으로 응답했거나, 본문이 없어 오류로 응답했으면 nullptr
+static const char* collectedBody(AsyncWebServerRequest *request, size_t maxSize) {
+  size_t length = request->contentLength();
+  if (length > maxSize) return nullptr; // collectBody()에서 413으로 응답함
+  if (!request->_tempObject) {
+    if (length == 0) {
+      request->send(400, "text/plain", "Empty body");
+    } else {
+      request->send(503, "text/plain", "Out of memory");
+    }
+    return nullptr;
+  }
+  return (const char *)request->_tempObject;
+}
+
+// ------------------ 일괄 제어 명령 (POST /commands) -----------------
+// {"v": 기대하는 상태 버전(생략 가능), "ops": [동작, ...]}
+//   {"a":"f", "on":true}                  팬 켜기 ("a": "f" 팬, "ht" 히터)
+//   {"a":"f", "on":true, "s":900}         팬 15분 켜고 다시 끄기
+//   {"a":"ht", "duty":[60,240], "s":3600} 히터 1분 켜고 4분 끄기를 1시간 동안 반복 ("s" 생략 시 무기한)
+// 동작은 순서대로 한 번에 적용되며, 하나라도 잘못되면 아무것도 적용하지 않음 (400).
+// "v"가 현재 상태 버전과 다르면(그 사이 다른 곳에서 바뀜) 적용하지 않고 409와 현재 상태를 돌려줌
+static const char* parseControlOp(JsonObject o, ControlOp& op) {
+  op = {};
+  const char* a = o["a"];
+  if (a && strcmp(a, "f") == 0) {
+    op.target = ACT_FAN;
+  } else if (a && strcmp(a, "ht") == 0) {
+    op.target = ACT_HEATER;
+  } else {
+    return "Unknown actuator";
+  }
+
+  uint32_t seconds = o["s"] | 0;
+  if (seconds > CONTROL_MAX_SECONDS) return "Duration too long";
+  op.forMs = seconds * 1000;
+
+  JsonArray duty = o["duty"];
+  if (!duty.isNull()) {
+    uint32_t onSec = duty[0] | 0;
+    uint32_t offSec = duty[1] | 0;
+    if (duty.size() != 2 || onSec == 0 || offSec == 0 || onSec > CONTROL_MAX_SECONDS || offSec > CONTROL_MAX_SECONDS) {
+      return "Invalid duty cycle";
+    }
+    op.dutyOnMs = onSec * 1000;
+    op.dutyOffMs = offSec * 1000;
+    return nullptr;
+  }
+
+  if (!o["on"].is<bool>()) return "Missing on";
+  op.on = o["on"].as<bool>();
+  return nullptr;
+}
+
+static void handleCommands(AsyncWebServerRequest *request) {
+  ScopedTimerUs timer(commandsUs);
+  D_PRINTLN("--- POST /commands 요청 수신 ---");
+  const char* body = collectedBody(request, COMMANDS_BODY_MAX);
+  if (!body) return;
+
+  JsonDocument doc;
+  bool msgpackBody = isMsgPackBody(request);
+  size_t len = request->contentLength();
+  DeserializationError err = msgpackBody ? deserializeMsgPack(doc, body, len)
+                                         : deserializeJson(doc, body, len);
+  if (err) {
+    request->send(400, "text/plain", msgpackBody ? "Invalid MessagePack" : "Invalid JSON");
+    return;
+  }
+
+  JsonArray list = doc["ops"];
+  if (list.isNull() || list.size() == 0 || list.size() > CONTROL_MAX_OPS) {
+    request->send(400, "text/plain", "ops must hold 1.." + String(CONTROL_MAX_OPS) + " operations");
+    return;
+  }
+  ControlOp ops[CONTROL_MAX_OPS];
+  size_t count = 0;
+  for (JsonObject o : list) {
+    const char* error = parseControlOp(o, ops[count]);
+    if (error) {
+      request->send(400, "text/plain", String(error) + " (op " + String(count) + ")");
+      return;
+    }
+    count++;
+  }
+
+  uint32_t version;
+  bool applied = applyControl(ops, count, doc["v"] | 0, &version);
+  D_PRINTF("제어 명령 %u개 %s (버전 %lu)\n", (unsigned)count, applied ? "적용" : "거절", (unsigned long)version);
+
+  // 적용 결과(또는 거절 시 현재 상태)와 상태 버전, 진행 중인 예약을 돌려줌
+  JsonDocument reply;
+  reply["v"] = version;
+  reply["f"] = deviceState.isFanOn;
+  reply["ht"] = deviceState.isHeaterOn;
+  JsonObject sch = reply["sch"].to<JsonObject>();
+  for (int t = 0; t < ACT_COUNT; t++) {
+    ControlSchedule s = controlSchedule((Actuator)t);
+    if (!s.active) continue;
+    JsonObject e = sch[t == ACT_FAN ? "f" : "ht"].to<JsonObject>();
+    e["d"] = s.duty;
+    e["r"] = (s.remainingMs + 999) / 1000; // 남은 시간(초), 0이면 무기한
+  }
+  sendDocument(request, reply, wantsMsgPack(request), nullptr, applied ? 200 : 409);
 }
 
 void setupWebServer() {
+  bootId = esp_random();
+
   // 현재 팬/히터 상태를 JSON으로 반환
   server.on("/status", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ScopedTimerUs timer(statusGetUs);
     D_PRINTLN("--- GET /status 요청 수신 ---");
+    bool msgpack = wantsMsgPack(request);
+    Validators validators;
+    makeValidators(validators, 'd', deviceStateVersion(), deviceStateChangedAt(), msgpack);
+    if (sendNotModified(request, validators)) return;
+
+    ReplySlot* slot = msgpack ? nullptr : acquireReply();
+    if (slot) {
+      formatStatusReply(slot);
+      sendReply(request, slot, &validators);
+      return;
+    }
+
     JsonDocument doc;
     doc["f"] = deviceState.isFanOn;
     doc["ht"] = deviceState.isHeaterOn;
-    String jsonResponse;
-    serializeJson(doc, jsonResponse);
-    request->send(200, "application/json", jsonResponse);
+    sendDocument(request, doc, msgpack, &validators);
   });
 
-  // JSON 요청을 받아 팬/히터 상태 변경
+  // JSON(또는 Content-Type이 application/msgpack이면 MessagePack) 요청을 받아 팬/히터 상태 변경
+  // 본문은 조각마다 모으기만 하고, 다 받은 뒤 요청 핸들러에서 한 번만 파싱/응답
   server.on(
     "/status", HTTP_POST,
-    [](AsyncWebServerRequest *request) {}, NULL,
-    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+    [](AsyncWebServerRequest *request) {
+      ScopedTimerUs timer(statusPostUs);
       D_PRINTLN("--- POST /status 요청 수신 ---");
+      const char* body = collectedBody(request, STATUS_BODY_MAX);
+      if (!body) return;
+
       JsonDocument doc;
-      if (deserializeJson(doc, (const char *)data, len)) {
-        request->send(400, "text/plain", "Invalid JSON");
+      bool msgpackBody = isMsgPackBody(request);
+      size_t len = request->contentLength();
+      DeserializationError err = msgpackBody ? deserializeMsgPack(doc, body, len)
+                                             : deserializeJson(doc, body, len);
+      if (err) {
+        request->send(400, "text/plain", msgpackBody ? "Invalid MessagePack" : "Invalid JSON");
         return;
       }
 
       if (doc["f"].is<bool>()) { // "fan_on" -> "f"
-        deviceState.isFanOn = doc["f"].as<bool>();
-        digitalWrite(FAN_CONTROL_PIN, deviceState.isFanOn ? HIGH : LOW);
+        setFan(doc["f"].as<bool>());
         myNex.writeNum("bt0.val", deviceState.isFanOn ? 1 : 0);
         D_PRINTF("팬 상태 변경: %s\n", deviceState.isFanOn ? "ON" : "OFF");
       }
 
       if (doc["ht"].is<bool>()) { // "heater_on" -> "ht"
-        deviceState.isHeaterOn = doc["ht"].as<bool>();
-        digitalWrite(MOSFET_PIN, deviceState.isHeaterOn ? HIGH : LOW);
+        setHeater(doc["ht"].as<bool>());
         myNex.writeNum("bt1.val", deviceState.isHeaterOn ? 1 : 0);
         D_PRINTF("히터 상태 변경: %s\n", deviceState.isHeaterOn ? "ON" : "OFF");
       }
 
-      // 변경된 상태를 다시 JSON으로 응답
-      String jsonResponse;
-      serializeJson(doc, jsonResponse);
-      request->send(200, "application/json", jsonResponse);
+      // 변경된 상태를 다시 응답 (Accept에 따라 JSON 또는 MessagePack)
+      sendDocument(request, doc, wantsMsgPack(request));
+    },
+    NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      collectBody(request, data, len, index, total, STATUS_BODY_MAX);
+    }
+  );
+
+  // 여러 제어 동작(예약 포함)을 한 번에 적용
+  server.on(
+    "/commands", HTTP_POST, handleCommands, NULL,
+    [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+      collectBody(request, data, len, index, total, COMMANDS_BODY_MAX);
     }
   );
 
   server.on("/sensors", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ScopedTimerUs timer(sensorsUs);
     D_PRINTLN("--- GET /sensors 요청 수신 ---");
-    float temp = dht.getTemperature();
-    float humi = dht.getHumidity();
-    float co2 = MQ135.readSensor() + 400;
-
-        // 2. 센서 읽기 실패 시 에러 응답을 보냄
-    if (isnan(temp) || isnan(humi) || isnan(co2)) {
+    // 1. 센서를 직접 읽지 않고 loop()가 갱신한 스냅샷 사용 (네트워크 Task가 막히지 않음)
+    SensorSnapshot s = sensorSnapshot();
+    float temp = s.temp;
+    float humi = s.humi;
+    float co2 = s.co2;
+
+        // 2. 센서 읽기 실패(또는 오래된 값) 시 에러 응답을 보냄
+    if (!sensorSnapshotFresh(s, SENSOR_STALE_MS)) {
         D_PRINTLN("센서 값 읽기 실패");
         request->send(503, "application/json", "{\"error\":\"Sensor read failure\"}");
         return;
         }
 
-        // 3. JSON 문서를 만들어 센서 값을 담습니다.
+        // 3. 값이 그대로면 304, JSON은 슬롯에 바로 기록 (힙 할당 없음)
+        bool msgpack = wantsMsgPack(request);
+        Validators validators;
+        makeValidators(validators, 's', s.version, s.changedAt, msgpack);
+        if (sendNotModified(request, validators)) return;
+
+        ReplySlot* slot = msgpack ? nullptr : acquireReply();
+        if (slot) {
+          formatSensorsReply(slot, temp, humi, co2);
+          sendReply(request, slot, &validators);
+          return;
+        }
+
+        // 슬롯이 없거나 MessagePack이면 문서를 만들어 센서 값을 담습니다. (MessagePack이면 온도/습도 x10 정수)
         JsonDocument doc;
-        doc["t"] = String(temp, 1); // "temperature" -> "t" (JSON key 축소)
-        doc["h"] = String(humi, 1);  // "humidity" -> "h" (JSON key 축소)
-        doc["c"] = String(co2, 0);   // "co2" -> "c" (JSON key 축소)
-
-        // 4. JSON을 문자열로 변환하여 응답으로 보냅니다.
-        String jsonResponse;
-        serializeJson(doc, jsonResponse);
-        request->send(200, "application/json", jsonResponse);
+        JsonObject o = doc.to<JsonObject>();
+        putFixed(o, "t", temp, 1, msgpack); // "temperature" -> "t" (JSON key 축소)
+        putFixed(o, "h", humi, 1, msgpack); // "humidity" -> "h" (JSON key 축소)
+        putFixed(o, "c", co2, 0, msgpack);  // "co2" -> "c" (JSON key 축소)
+
+        // 4. 요청한 형식으로 변환하여 응답으로 보냅니다.
+        sendDocument(request, doc, msgpack, &validators);
   });
+  // 소리 분류 통계: 분류 결과별 횟수, 녹음/생략 횟수, 마지막 분류 결과
+  server.on("/classifier", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ScopedTimerUs timer(classifierUs);
+    D_PRINTLN("--- GET /classifier 요청 수신 ---");
+    ClassifierStats stats = classifierStats();
+    ClassifierResult last = lastClassification();
+    bool msgpack = wantsMsgPack(request);
+
+    JsonDocument doc;
+    doc["bark"] = stats.counts[SOUND_BARK];
+    doc["whine"] = stats.counts[SOUND_WHINE];
+    doc["other"] = stats.counts[SOUND_OTHER];
+    doc["rec"] = stats.recorded;
+    doc["skip"] = stats.skipped; // 분류 덕분에 생략한 인코딩/업로드 횟수
+    doc["us"] = stats.lastMicros;
+
+    JsonObject l = doc["last"].to<JsonObject>();
+    l["c"] = soundClassName(last.cls);
+    l["fc"] = last.forced;
+    l["ago"] = last.at ? (millis() - last.at) / 1000 : 0;
+    l["ct"] = (int)last.features.centroidHz;
+    putFixed(l, "fl", last.features.flatness, 3, msgpack);
+    putFixed(l, "bs", last.features.barkShare, 3, msgpack);
+    putFixed(l, "ps", last.features.peakShare, 3, msgpack);
+
+    sendDocument(request, doc, msgpack);
+  });
+  // 업로드 서버 연결 재사용 통계와 요청 지연 시간
+  server.on("/uplink", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ScopedTimerUs timer(uplinkUs);
+    D_PRINTLN("--- GET /uplink 요청 수신 ---");
+    UplinkStats stats = uplink.stats();
+    bool msgpack = wantsMsgPack(request);
+
+    JsonDocument doc;
+    JsonObject o = doc.to<JsonObject>();
+    doc["req"] = stats.requests;
+    doc["con"] = stats.connects;
+    doc["reuse"] = stats.reuses;
+    doc["stale"] = stats.stale;
+    doc["fail"] = stats.failures;
+    doc["ms"] = stats.lastMs;
+    putFixed(o, "new_ms", stats.avgNewMs, 1, msgpack);
+    putFixed(o, "reuse_ms", stats.avgReusedMs, 1, msgpack);
+
+    sendDocument(request, doc, msgpack);
+  });
+  // 센서 데이터 일괄 업로드 상태
+  server.on("/telemetry", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ScopedTimerUs timer(telemetryUs);
+    D_PRINTLN("--- GET /telemetry 요청 수신 ---");
+    TelemetryStats stats = telemetryStats();
+
+    JsonDocument doc;
+    doc["n"] = stats.samples;
+    doc["wait"] = stats.pending;
+    doc["sent"] = stats.batches;
+    doc["fail"] = stats.failures;
+    doc["drop"] = stats.dropped;
+
+    sendDocument(request, doc, wantsMsgPack(request));
+  });
+  // 실시간 MP3 스트림 (청취자가 있는 동안만 인코딩)
+  server.on("/live", HTTP_GET, handleLiveRequest);
+  // 계측 지표 (Prometheus 텍스트 형식)
+  server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request) {
+    ScopedTimerUs timer(metricsUs);
+    AsyncResponseStream *response = request->beginResponseStream("text/plain; version=0.0.4", 4096);
+    Metric::writeAll(*response);
+    request->send(response);
+  });
+
+  // 상태/센서 변경 푸시 (Server-Sent Events)
+  setupPush();
+
   server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
     request->send(200, "text/plain", "Pet Care System is running!");
   });
@@ -162,32 +583,236 @@ void setupWebServer() {
   D_PRINTLN("웹 서버 시작.");
 }
 
-void uploadSensorData(float temp, float humi, float co2) {
-  if (WiFi.status() != WL_CONNECTED) {
-    D_PRINTLN("WiFi 연결이 끊겨 센서 데이터를 업로드할 수 없습니다.");
-    return;
+bool ChunkedPost::begin(const char* path, const String& contentType) {
+  client.print(String("POST ") + path + " HTTP/1.1\r\n");
+  client.print("Host: " + String(upload_server) + "\r\n");
+  client.print("Connection: keep-alive\r\n");
+  client.print("Content-Type: " + contentType + "\r\n");
+  client.print("Transfer-Encoding: chunked\r\n\r\n");
+  error = !client.connected();
+  return !error;
+}
+
+bool ChunkedPost::write(const uint8_t* data, size_t len) {
+  if (error) return false;
+  if (len == 0) return true;
+
+  char size_line[12];
+  int n = snprintf(size_line, sizeof(size_line), "%X\r\n", (unsigned)len);
+  if (client.write((const uint8_t*)size_line, n) != (size_t)n ||
+      client.write(data, len) != len ||
+      client.write((const uint8_t*)"\r\n", 2) != 2) {
+    error = true;
+    return false;
   }
+  sent += len;
+  return true;
+}
 
-  JsonDocument doc;
-  doc["t"] = String(temp, 1);
-  doc["h"] = String(humi, 1);
-  doc["c"] = String(co2, 0);
-  doc["d"] = getCurrentDateTime();
-  doc["i"] = device_id;
-  String jsonData;
-  serializeJson(doc, jsonData);
-
-  D_PRINTLN("센서 데이터 업로드");
-  D_PRINTLN(jsonData);
-
-  HTTPClient http;
-  String serverPath = "http://" + String(upload_server) + ":" + String(upload_port) + String(upload_sensor_path);
-  http.begin(serverPath);
-  http.addHeader("Content-Type", "application/json");
-
-  int httpResponseCode = http.POST(jsonData);
-  D_PRINTF("HTTP 응답 코드: %d\n", httpResponseCode);
-  http.end();
+bool ChunkedPost::end() {
+  if (error) return false;
+  if (client.write((const uint8_t*)"0\r\n\r\n", 5) != 5) {
+    error = true;
+  }
+  return !error;
+}
+
+int ChunkedPost::readResponse(unsigned long timeoutMs) {
+  return readHttpResponse(client, timeoutMs, &reusable);
+}
+
+// deadline까지 읽을 데이터가 들어오기를 기다림. 연결이 끊기거나 시간이 지나면 false
+static bool waitAvailable(WiFiClient& client, unsigned long deadline) {
+  while (!client.available()) {
+    if (!client.connected() || (long)(millis() - deadline) >= 0) return false;
+    delay(5);
+  }
+  return true;
+}
+
+static bool readLine(WiFiClient& client, unsigned long deadline, String& line) {
+  if (!waitAvailable(client, deadline)) return false;
+  line = client.readStringUntil('\n');
+  line.trim();
+  return true;
+}
+
+// 본문 n바이트를 읽어 버림 (디버그 출력용으로 앞부분만 preview에 보관)
+static bool skipBody(WiFiClient& client, size_t n, unsigned long deadline, String& preview) {
+  uint8_t buf[128];
+  while (n > 0) {
+    if (!waitAvailable(client, deadline)) return false;
+    int got = client.read(buf, min(n, sizeof(buf)));
+    if (got <= 0) return false;
+    if (preview.length() < 256) preview.concat((const char*)buf, min((size_t)got, 256 - preview.length()));
+    n -= got;
+  }
+  return true;
+}
+
+int readHttpResponse(WiFiClient& client, unsigned long timeoutMs, bool* keepAlive) {
+  *keepAlive = false;
+  unsigned long deadline = millis() + timeoutMs;
+
+  // 상태 줄: "HTTP/1.1 200 OK"
+  String status;
+  if (!readLine(client, deadline, status)) {
+    // 시간 초과면 서버가 요청을 처리 중이었을 수 있음. 그 전에 끊겼다면 서버가 이미 닫은 연결
+    return (long)(millis() - deadline) >= 0 ? HTTP_TIMEOUT : HTTP_CLOSED;
+  }
+  int space = status.indexOf(' ');
+  int code = space > 0 ? status.substring(space + 1).toInt() : -1;
+  bool close = status.startsWith("HTTP/1.0"); // 1.0은 기본이 연결 종료
+  long contentLength = -1;
+  bool chunked = false;
+
+  String line;
+  while (readLine(client, deadline, line) && line.length() > 0) {
+    const char* h = line.c_str();
+    if (strncasecmp(h, "Content-Length:", 15) == 0) {
+      contentLength = atol(h + 15);
+    } else if (strncasecmp(h, "Transfer-Encoding:", 18) == 0) {
+      chunked = strcasestr(h + 18, "chunked") != NULL;
+    } else if (strncasecmp(h, "Connection:", 11) == 0) {
+      close = strcasestr(h + 11, "close") != NULL;
+    }
+  }
+
+  // 다음 응답과 섞이지 않도록 본문을 끝까지 읽음
+  String body;
+  bool complete = true;
+  if (code == 204 || code == 304 || (code >= 100 && code < 200)) {
+    // 본문 없음
+  } else if (chunked) {
+    for (;;) {
+      if (!readLine(client, deadline, line)) { complete = false; break; }
+      size_t size = strtoul(line.c_str(), NULL, 16);
+      if (size == 0) {
+        while (readLine(client, deadline, line) && line.length() > 0) {} // 트레일러
+        break;
+      }
+      if (!skipBody(client, size, deadline, body) || !readLine(client, deadline, line)) { complete = false; break; }
+    }
+  } else if (contentLength >= 0) {
+    complete = skipBody(client, contentLength, deadline, body);
+  } else {
+    // 길이 정보가 없으면 서버가 연결을 닫을 때까지가 본문
+    while (skipBody(client, 1, deadline, body)) {}
+    complete = false;
+  }
+
+  D_PRINTLN("--- 서버 응답 ---");
+  D_PRINTLN(status);
+  D_PRINTLN(body);
+  D_PRINTLN("-----------------");
+
+  *keepAlive = complete && !close && client.connected();
+  return code;
+}
+
+// ------------------ 업로드 서버 keep-alive 연결 -----------------
+Uplink uplink;
+static portMUX_TYPE uplinkStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+void Uplink::begin() {
+  if (!mutex) mutex = xSemaphoreCreateMutex();
+}
+
+WiFiClient* Uplink::acquire() {
+  if (!mutex) return nullptr;
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  started = millis();
+
+  // 오래 쉰 연결은 서버의 keep-alive 시간이 지나 닫혔을 수 있고,
+  // 요청하지 않은 데이터가 와 있다면 서버가 닫으면서 보낸 응답이므로 둘 다 버림
+  if (client.connected() && (millis() - lastUsed > UPLINK_IDLE_MS || client.available())) {
+    client.stop();
+  }
+
+  if (client.connected()) {
+    reusedConn = true;
+    return &client;
+  }
+
+  client.stop();
+  reusedConn = false;
+  if (!client.connect(upload_server, upload_port)) {
+    D_PRINTLN("서버 연결 실패!");
+    portENTER_CRITICAL(&uplinkStatsMux);
+    counters.failures++;
+    portEXIT_CRITICAL(&uplinkStatsMux);
+    xSemaphoreGive(mutex);
+    return nullptr;
+  }
+  client.setNoDelay(true);
+  portENTER_CRITICAL(&uplinkStatsMux);
+  counters.connects++;
+  portEXIT_CRITICAL(&uplinkStatsMux);
+  return &client;
+}
+
+void Uplink::release(int code, bool keepAlive) {
+  uint32_t elapsed = millis() - started;
+  if (code < 0 || !keepAlive) client.stop();
+  lastUsed = millis();
+
+  portENTER_CRITICAL(&uplinkStatsMux);
+  if (code < 0) {
+    counters.failures++;
+  } else {
+    counters.requests++;
+    counters.lastMs = elapsed;
+    // 지수 이동 평균 (1/8)
+    float& avg = reusedConn ? counters.avgReusedMs : counters.avgNewMs;
+    avg = avg == 0 ? elapsed : avg + (elapsed - avg) / 8;
+    if (reusedConn) counters.reuses++;
+  }
+  portEXIT_CRITICAL(&uplinkStatsMux);
+  if (code >= 0) (reusedConn ? uplinkReusedMs : uplinkNewMs).observe(elapsed);
+
+  xSemaphoreGive(mutex);
+}
+
+void Uplink::noteStale() {
+  portENTER_CRITICAL(&uplinkStatsMux);
+  counters.stale++;
+  portEXIT_CRITICAL(&uplinkStatsMux);
+}
+
+int Uplink::post(const char* path, const char* contentType, const String& body) {
+  int code = HTTP_CONNECT_FAILED;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    WiFiClient* c = acquire();
+    if (!c) return HTTP_CONNECT_FAILED;
+
+    String head = String("POST ") + path + " HTTP/1.1\r\n";
+    head += "Host: " + String(upload_server) + "\r\n";
+    head += "Connection: keep-alive\r\n";
+    head += "Content-Type: " + String(contentType) + "\r\n";
+    head += "Content-Length: " + String(body.length()) + "\r\n\r\n";
+
+    bool keepAlive = false;
+    code = HTTP_SEND_FAILED;
+    if (c->print(head) == head.length() &&
+        c->write((const uint8_t*)body.c_str(), body.length()) == body.length()) {
+      code = readHttpResponse(*c, UPLINK_TIMEOUT_MS, &keepAlive);
+    }
+
+    bool stale = staleFailure(code);
+    release(code, keepAlive);
+    if (!stale) return code;
+    // 재사용한 연결이 그 사이 끊어져 있었음 → 새 연결로 한 번 더
+    noteStale();
+    D_PRINTLN("끊어진 keep-alive 연결, 다시 연결합니다.");
+  }
+  return code; // 새 연결에서도 끊어졌던 경우
+}
+
+UplinkStats Uplink::stats() {
+  portENTER_CRITICAL(&uplinkStatsMux);
+  UplinkStats copy = counters;
+  portEXIT_CRITICAL(&uplinkStatsMux);
+  return copy;
 }
 
 String getCurrentDateTime() {
@@ -4,8 +4,91 @@
 
 void setupWiFi();
 void setupWebServer();
-void uploadSensorData(float temp, float humi, float co2);
 String getCurrentDateTime();
 void enterAPMode(); // trigger1
 
+// 업로드 요청 실패 코드 (HTTP 상태 코드 대신 반환)
+const int HTTP_TIMEOUT = -1;     // 응답을 기다리다 시간 초과. 서버가 요청을 이미 처리했을 수 있음
+const int HTTP_CLOSED = -2;      // 응답 첫 바이트를 받기 전에 연결이 끊김
+const int HTTP_SEND_FAILED = -3; // 요청 전송 실패
+const int HTTP_CONNECT_FAILED = -4; // 서버에 연결하지 못함 (요청을 보내지 않음)
+
+// HTTP/1.1 chunked transfer로 본문 길이를 모르는 상태에서 바로 전송하는 POST 요청
+class ChunkedPost {
+public:
+  explicit ChunkedPost(WiFiClient& client) : client(client) {}
+
+  // 요청 라인과 헤더 전송
+  bool begin(const char* path, const String& contentType);
+  // 청크 하나 전송 (len == 0이면 무시)
+  bool write(const uint8_t* data, size_t len);
+  bool write(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+  // 종료 청크 전송
+  bool end();
+  // 서버 응답을 본문 끝까지 읽어 HTTP 상태 코드를 반환 (응답 내용은 디버그 출력). 실패하면 HTTP_TIMEOUT/HTTP_CLOSED
+  int readResponse(unsigned long timeoutMs);
+
+  bool failed() const { return error; }
+  size_t bodyBytes() const { return sent; }
+  // 응답을 다 읽은 뒤 연결을 다음 요청에 재사용할 수 있는지
+  bool keepAlive() const { return reusable; }
+
+private:
+  WiFiClient& client;
+  bool error = false;
+  bool reusable = false;
+  size_t sent = 0;
+};
+
+// 응답 헤더와 본문(Content-Length 또는 chunked)을 끝까지 읽어 상태 코드를 반환
+// 상태 줄을 받지 못하면 시간 초과는 HTTP_TIMEOUT, 그 전에 연결이 끊기면 HTTP_CLOSED
+// keepAlive에는 같은 연결로 다음 요청을 보낼 수 있는지가 기록됨
+int readHttpResponse(WiFiClient& client, unsigned long timeoutMs, bool* keepAlive);
+
+struct UplinkStats {
+  uint32_t requests;     // 완료된 요청 수
+  uint32_t connects;     // 새로 맺은 TCP 연결 수
+  uint32_t reuses;       // 기존 연결을 재사용한 요청 수
+  uint32_t stale;        // 끊어진 연결을 발견해 다시 연결한 횟수
+  uint32_t failures;     // 연결 실패 또는 응답 없음
+  uint32_t lastMs;       // 마지막 요청 지연 시간 (연결 포함)
+  float avgNewMs;        // 새 연결 요청의 평균 지연 시간
+  float avgReusedMs;     // 재사용 연결 요청의 평균 지연 시간
+};
+
+// 업로드 서버(upload_server:upload_port)와의 keep-alive 연결 하나를 센서/녹음 업로드가 함께 사용
+// 요청마다 acquire()로 연결을 빌리고 release()로 돌려줌 (그 사이에는 다른 Task가 사용할 수 없음)
+// 오래 쉬었거나 서버가 닫은 연결은 acquire()에서 버리고 새로 연결합니다.
+class Uplink {
+public:
+  void begin();
+
+  // 연결을 확보해 돌려줌. 연결 실패 시 nullptr (이때는 release() 호출 불필요)
+  WiFiClient* acquire();
+  // 요청 종료. code < 0 이거나 keepAlive가 아니면 연결을 닫음
+  void release(int code, bool keepAlive);
+  // 이번 acquire()가 기존 연결을 재사용했는지
+  bool reused() const { return reusedConn; }
+  // 재사용한 연결이 이미 끊어져 있어 서버가 요청을 받지 못한 실패인지 (전송 실패 또는 응답 전에 연결 끊김)
+  // 이때만 새 연결로 재시도. 응답 시간 초과는 서버가 이미 처리했을 수 있으므로 재시도하지 않음
+  bool staleFailure(int code) const { return reusedConn && (code == HTTP_SEND_FAILED || code == HTTP_CLOSED); }
+  // 재사용 연결이 끊어져 있었음을 기록
+  void noteStale();
+
+  // 길이를 아는 본문을 POST하고 상태 코드(실패하면 음수)를 반환. 재사용한 연결이 끊어져 있었으면 새 연결로 한 번 재시도
+  int post(const char* path, const char* contentType, const String& body);
+
+  UplinkStats stats();
+
+private:
+  WiFiClient client;
+  SemaphoreHandle_t mutex = NULL;
+  unsigned long lastUsed = 0;
+  unsigned long started = 0;
+  bool reusedConn = false;
+  UplinkStats counters = {};
+};
+
+extern Uplink uplink;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+// push.cpp
+
+#include "config.h"
+#include "push.h"
+#include "sensors.h" // 센서 스냅샷
+#include "control.h" // 상태 버전
+#include <atomic>
+#include <memory>
+
+// 값 하나씩 비교하는 기준 (클라이언트마다 마지막으로 보낸 값)
+struct PushState {
+  bool fan;
+  bool heater;
+  int32_t temp; // 0.1°C
+  int32_t humi; // 0.1%
+  int32_t co2;  // ppm
+  bool sensorsValid;
+};
+
+// 클라이언트별 전송 상태 (async_tcp Task에서만 접근)
+struct PushClient {
+  PushState sent;
+  uint32_t stateVersion;
+  uint32_t sensorVersion;
+  unsigned long lastSent;
+  bool greeted; // 연결 직후 전체 값을 보냈는지
+};
+
+static std::atomic<uint32_t> clients(0);
+static std::atomic<uint32_t> eventId(0);
+
+static void capture(PushState& p, const SensorSnapshot& s) {
+  p.fan = deviceState.isFanOn;
+  p.heater = deviceState.isHeaterOn;
+  p.sensorsValid = sensorSnapshotFresh(s, SENSOR_STALE_MS);
+  p.temp = lroundf(s.temp * 10);
+  p.humi = lroundf(s.humi * 10);
+  p.co2 = lroundf(s.co2);
+}
+
+// {"f":..,"ht":..} 중 sent와 다른 필드만 (all이면 전부). 바뀐 것이 없으면 0
+static int formatStatus(char* out, size_t size, const PushState& now, const PushState& sent, bool all) {
+  int n = 0;
+  if (all || now.fan != sent.fan) {
+    n += snprintf(out + n, size - n, "%s\"f\":%s", n ? "," : "{", now.fan ? "true" : "false");
+  }
+  if (all || now.heater != sent.heater) {
+    n += snprintf(out + n, size - n, "%s\"ht\":%s", n ? "," : "{", now.heater ? "true" : "false");
+  }
+  if (n) n += snprintf(out + n, size - n, "}");
+  return n;
+}
+
+static int formatSensors(char* out, size_t size, const PushState& now, const PushState& sent, bool all) {
+  if (!now.sensorsValid) return 0;
+  all = all || !sent.sensorsValid;
+  int n = 0;
+  if (all || now.temp != sent.temp) {
+    n += snprintf(out + n, size - n, "%s\"t\":\"%.1f\"", n ? "," : "{", now.temp / 10.0f);
+  }
+  if (all || now.humi != sent.humi) {
+    n += snprintf(out + n, size - n, "%s\"h\":\"%.1f\"", n ? "," : "{", now.humi / 10.0f);
+  }
+  if (all || now.co2 != sent.co2) {
+    n += snprintf(out + n, size - n, "%s\"c\":\"%ld\"", n ? "," : "{", (long)now.co2);
+  }
+  if (n) n += snprintf(out + n, size - n, "}");
+  return n;
+}
+
+// SSE 이벤트 하나를 out에 기록하고 길이를 반환
+static int appendEvent(char* out, size_t size, const char* name, const char* data) {
+  return snprintf(out, size, "id: %lu\nevent: %s\ndata: %s\n\n",
+                  (unsigned long)eventId.fetch_add(1) + 1, name, data);
+}
+
+// 클라이언트 송신 버퍼에 자리가 났을 때 호출됨. 마지막으로 보낸 이후 바뀐 필드를 이벤트로 만듦
+static size_t fillEvents(PushClient& c, uint8_t* buffer, size_t maxLen) {
+  if (c.greeted && millis() - c.lastSent < PUSH_INTERVAL_MS) return RESPONSE_TRY_AGAIN;
+
+  SensorSnapshot s = sensorSnapshot();
+  uint32_t stateVersion = deviceStateVersion();
+  bool stateChanged = !c.greeted || stateVersion != c.stateVersion;
+  bool sensorsChanged = !c.greeted || s.version != c.sensorVersion;
+  if (!stateChanged && !sensorsChanged) return RESPONSE_TRY_AGAIN;
+
+  // 두 이벤트가 다 들어갈 자리가 없으면 다음 호출까지 미룸 (이벤트를 쪼개 보내지 않음)
+  char events[256];
+  if (maxLen < sizeof(events)) return RESPONSE_TRY_AGAIN;
+
+  PushState now;
+  capture(now, s);
+  char data[96];
+  int n = 0;
+  if (!c.greeted) n += snprintf(events, sizeof(events), "retry: 3000\n\n");
+  if (stateChanged && formatStatus(data, sizeof(data), now, c.sent, !c.greeted)) {
+    n += appendEvent(events + n, sizeof(events) - n, "status", data);
+  }
+  if (sensorsChanged && formatSensors(data, sizeof(data), now, c.sent, !c.greeted)) {
+    n += appendEvent(events + n, sizeof(events) - n, "sensors", data);
+  }
+  c.sent = now;
+  c.stateVersion = stateVersion;
+  c.sensorVersion = s.version;
+  c.greeted = true;
+  if (n == 0) return RESPONSE_TRY_AGAIN; // 버전만 바뀌고 보낼 값은 같음
+
+  c.lastSent = millis();
+  memcpy(buffer, events, n);
+  return n;
+}
+
+static void handleEventsRequest(AsyncWebServerRequest *request) {
+  D_PRINTLN("--- /events 클라이언트 연결 ---");
+  if (clients.fetch_add(1) >= (uint32_t)PUSH_MAX_CLIENTS) {
+    clients.fetch_sub(1);
+    request->send(503, "text/plain", "Too many listeners");
+    return;
+  }
+
+  auto client = std::make_shared<PushClient>(); // 0으로 초기화 → 첫 호출에서 전체 값 전송
+
+  AsyncWebServerResponse *response = request->beginChunkedResponse("text/event-stream",
+    [client](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+      return fillEvents(*client, buffer, maxLen);
+    });
+  response->addHeader("Cache-Control", "no-cache");
+  request->onDisconnect([]() {
+    clients.fetch_sub(1);
+    D_PRINTLN("/events 클라이언트 연결 종료.");
+  });
+  request->send(response);
+}
+
+void setupPush() {
+  server.on("/events", HTTP_GET, handleEventsRequest);
+}
@@ -0,0 +1,21 @@
+// push.h
+
+#ifndef PUSH_H
+#define PUSH_H
+
+// 상태/센서 변경 푸시 (Server-Sent Events, GET /events)
+// 대시보드가 /status, /sensors를 폴링하는 대신 /events를 열어 두면, 팬/히터 상태나 센서 값이 바뀔 때
+// 바뀐 필드만 담은 이벤트를 받습니다.
+//   event: status   data: {"f":true}                 (GET /status와 같은 키)
+//   event: sensors  data: {"t":"25.3","c":"412"}     (GET /sensors와 같은 키와 형식)
+// 연결 직후에는 전체 값을 한 번 보냅니다.
+//
+// 클라이언트마다 chunked 응답 하나와 "마지막으로 보낸 값"을 두고, 그 클라이언트의 송신 버퍼에 자리가 날 때만
+// 그 사이 바뀐 필드를 만들어 보냅니다 (/live와 같은 방식). 따라서 클라이언트별 대기열은 이벤트 한 묶음을 넘지 않고,
+// 느리거나 멈춘 클라이언트는 다른 클라이언트를 막지 않은 채 변경이 합쳐진 이벤트를 나중에 받습니다.
+// 같은 클라이언트에는 PUSH_INTERVAL_MS에 한 번까지만 보내므로 짧은 시간 안의 연속 변경은 하나로 합쳐집니다.
+
+// /events 핸들러 등록 (server.begin() 전에 호출)
+void setupPush();
+
+#endif
@@ -3,9 +3,13 @@
 #include "config.h"
 #include "sensors.h"
 #include "display.h" // updateDisplay() 호출을 위해 포함
-#include "network.h" // uploadSensorData() 호출을 위해 포함
+#include "telemetry.h" // 센서 데이터 일괄 업로드
 
 unsigned long last_update = 0;
+unsigned long last_telemetry = 0;
+
+static SensorSnapshot snapshot = {};
+static portMUX_TYPE snapshotMux = portMUX_INITIALIZER_UNLOCKED;
 
 void setupPins() {
   pinMode(FAN_CONTROL_PIN, OUTPUT);
@@ -35,6 +39,48 @@ void setupSensors() {
   }
   MQ135.setR0(R0 / 10.0);
   D_PRINTLN(" 완료!");
+
+  sampleSensors(); // 첫 스냅샷
+}
+
+void sampleSensors() {
+  bool isOccupied = (digitalRead(PIR_PIN) == HIGH);
+  float temp = dht.getTemperature();
+  float humi = dht.getHumidity();
+  float co2 = MQ135.readSensor() + 400;
+  bool ok = !(isnan(temp) || isnan(humi) || isnan(co2) || isinf(co2));
+  time_t now = time(NULL);
+
+  portENTER_CRITICAL(&snapshotMux);
+  // 응답 본문과 같은 해상도로 비교해, 보이는 값이 그대로면 버전을 유지
+  bool changed = ok != snapshot.valid ||
+                 (ok && (lroundf(temp * 10) != lroundf(snapshot.temp * 10) ||
+                         lroundf(humi * 10) != lroundf(snapshot.humi * 10) ||
+                         lroundf(co2) != lroundf(snapshot.co2)));
+  if (changed) {
+    snapshot.version++;
+    snapshot.changedAt = now < 1600000000 ? 0 : now;
+  }
+  snapshot.occupied = isOccupied;
+  snapshot.valid = ok;
+  if (ok) {
+    snapshot.temp = temp;
+    snapshot.humi = humi;
+    snapshot.co2 = co2;
+    snapshot.at = millis();
+  }
+  portEXIT_CRITICAL(&snapshotMux);
+}
+
+SensorSnapshot sensorSnapshot() {
+  portENTER_CRITICAL(&snapshotMux);
+  SensorSnapshot copy = snapshot;
+  portEXIT_CRITICAL(&snapshotMux);
+  return copy;
+}
+
+bool sensorSnapshotFresh(const SensorSnapshot& s, uint32_t maxAgeMs) {
+  return s.valid && s.at != 0 && millis() - s.at <= maxAgeMs;
 }
 
 // 주기적으로 센서 값을 읽고 디스플레이를 업데이트하는 메인 함수
@@ -42,31 +88,32 @@ void handleSensorAndDisplayUpdates() {
   if (millis() - last_update >= update_interval) {
     last_update = millis();
 
-    bool isOccupied = (digitalRead(PIR_PIN) == HIGH);
-    float temp = dht.getTemperature();
-    float humi = dht.getHumidity();
-    float co2 = MQ135.readSensor();
-
-    if (isnan(temp) || isnan(humi) || isnan(co2) || isinf(co2)) {
+    sampleSensors();
+    SensorSnapshot s = sensorSnapshot();
+    if (!s.valid) {
       D_PRINTLN("센서 값 읽기 실패");
       return;
     }
 
     // Nextion 디스플레이 업데이트
-    updateDisplay(temp, humi, co2 + 400, WiFi.RSSI(), isOccupied);
+    updateDisplay(s.temp, s.humi, s.co2, WiFi.RSSI(), s.occupied);
+
+    // 업로드할 센서 데이터는 TELEMETRY_SAMPLE_MS마다 모아 두었다가 한꺼번에 전송
+    if (last_telemetry == 0 || millis() - last_telemetry >= TELEMETRY_SAMPLE_MS) {
+      last_telemetry = millis();
+      telemetryAdd(s.temp, s.humi, s.co2);
+    }
   }
 }
 
 // Nextion 버튼으로 센서 데이터 강제 전송
 void forceUploadSensorData() {
   D_PRINTLN("Nextion 요청: 센서 데이터 강제 업로드");
-  float temp = dht.getTemperature();
-  float humi = dht.getHumidity();
-  float co2 = MQ135.readSensor() + 400;
-
-  if (isnan(temp) || isnan(humi)) {
+  SensorSnapshot s = sensorSnapshot();
+  if (!sensorSnapshotFresh(s, SENSOR_STALE_MS)) {
      D_PRINTLN("센서 값 읽기 실패, 업로드 취소");
      return;
   }
-  uploadSensorData(temp, humi, co2);
-}
\ No newline at end of file
+  telemetryAdd(s.temp, s.humi, s.co2);
+  telemetryFlush(); // 모아 둔 샘플과 함께 바로 전송
+}
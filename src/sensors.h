@@ -3,9 +3,34 @@
 #ifndef SENSORS_H
 #define SENSORS_H
 
+#include <stdint.h>
+#include <time.h>
+
+// 센서 스냅샷
+// 센서는 loop()에서 update_interval마다 한 번만 읽고, 결과를 스냅샷으로 공개합니다.
+// 웹 핸들러, 디스플레이, 센서 데이터 업로드, Audio Task는 센서를 직접 읽지 않고 스냅샷을 복사해 씁니다.
+// (DHT11 읽기는 인터럽트를 끈 채 수 ms 동안 막히므로 네트워크 Task에서 호출하면 안 됨)
+struct SensorSnapshot {
+  float temp;     // °C
+  float humi;     // %
+  float co2;      // ppm
+  bool occupied;  // PIR
+  bool valid;     // 마지막 읽기 성공 여부 (실패하면 값은 마지막 성공 값 유지)
+  uint32_t at;    // 마지막 성공 시각 (millis), 0이면 아직 한 번도 성공하지 못함
+  uint32_t version;  // 응답에 보이는 값(0.1 단위)이나 유효성이 바뀔 때마다 증가 (GET /sensors의 ETag)
+  time_t changedAt;  // 마지막으로 version이 바뀐 시각 (epoch 초, 시간 동기화 전이면 0)
+};
+
 void setupPins();
 void setupSensors();
 void handleSensorAndDisplayUpdates();
 void forceUploadSensorData(); // trigger2
 
+// 센서를 한 번 읽어 스냅샷 갱신
+void sampleSensors();
+// 가장 최근 스냅샷 복사본
+SensorSnapshot sensorSnapshot();
+// 스냅샷이 유효하고 maxAgeMs 이내에 측정된 값인지
+bool sensorSnapshotFresh(const SensorSnapshot& s, uint32_t maxAgeMs);
+
 #endif
\ No newline at end of file
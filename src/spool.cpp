@@ -0,0 +1,391 @@
+// spool.cpp
+
+#include "config.h"
+#include "spool.h"
+#include "network.h" // ChunkedPost, uplink
+#include "metrics.h"
+#include <LittleFS.h>
+
+static const char* SPOOL_DIR = "/spool";
+static const int MAX_ORPHANS = 16;    // 부팅 시 한 번에 정리할 미완성 파일 수
+static const int MAX_SCAN_PASSES = 8; // 미완성 파일이 MAX_ORPHANS개보다 많을 때 다시 훑는 최대 횟수
+
+static uint8_t writeBuffer[SPOOL_WRITE_BUFFER];
+static uint8_t uploadBuffer[1460]; // TCP 세그먼트 하나
+
+struct SpoolStats {
+  uint32_t clips;    // 업로드 대기 중인 클립
+  uint32_t uploaded; // 업로드 성공
+  uint32_t failures; // 업로드 실패 (재시도 포함)
+  uint32_t evicted;  // 공간 부족으로 지운 클립
+  uint32_t corrupt;  // 메타데이터를 읽을 수 없어 업로드하지 못하고 지운 클립
+};
+
+static SemaphoreHandle_t spoolMutex = NULL; // 클립 번호 할당, 공간 확보(삭제), 업로드 대상 선택
+static TaskHandle_t uploaderTaskHandle = NULL;
+static uint32_t nextId = 1;
+static bool spoolReady = false;  // 마운트, 뮤텍스, 업로드 Task가 모두 준비됨
+static uint32_t uploadingId = 0; // 업로드 중인 클립은 지우지 않음
+static uint32_t stuckId = 0;     // 지울 수 없는 클립. 대기열을 막거나 반복 업로드되지 않도록 업로드 대상에서 제외
+static SpoolStats stats = {};
+
+// 계측: 32비트 값은 락 없이 읽어도 찢어지지 않으므로 stats를 그대로 읽음
+static Gauge clipsGauge("pet_spool_clips", "Recorded clips waiting for upload", nullptr,
+                        []() -> int32_t { return stats.clips; });
+static Counter uploadedCounter("pet_spool_uploaded_total", "Clips uploaded", nullptr,
+                               []() -> uint32_t { return stats.uploaded; });
+static Counter failureCounter("pet_spool_upload_failures_total", "Clip upload attempts that failed", nullptr,
+                              []() -> uint32_t { return stats.failures; });
+static Counter evictedCounter("pet_spool_evicted_total", "Clips deleted before upload to free space", nullptr,
+                              []() -> uint32_t { return stats.evicted; });
+static Counter corruptCounter("pet_spool_corrupt_total", "Clips deleted because their metadata could not be read", nullptr,
+                              []() -> uint32_t { return stats.corrupt; });
+static Histogram uploadMs("pet_spool_upload_ms", "Clip upload time in milliseconds", nullptr,
+                          DURATION_MS_BOUNDS, DURATION_MS_BOUNDS_COUNT);
+
+static String clipPath(uint32_t id, const char* ext) {
+  char path[32];
+  snprintf(path, sizeof(path), "%s/%08lu.%s", SPOOL_DIR, (unsigned long)id, ext);
+  return String(path);
+}
+
+static size_t freeBytes() {
+  size_t total = LittleFS.totalBytes();
+  size_t used = LittleFS.usedBytes();
+  return total > used ? total - used : 0;
+}
+
+// 완성된(.json이 있는) 클립 중 가장 오래된 번호. except는 제외. 없으면 0
+static uint32_t oldestClip(uint32_t except) {
+  uint32_t oldest = 0;
+  File dir = LittleFS.open(SPOOL_DIR);
+  if (!dir) return 0;
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    const char* name = f.name();
+    const char* dot = strrchr(name, '.');
+    if (!dot || strcmp(dot, ".json") != 0) continue;
+    uint32_t id = strtoul(name, NULL, 10);
+    if (id != 0 && id != except && (oldest == 0 || id < oldest)) oldest = id;
+  }
+  return oldest;
+}
+
+// .json을 먼저 지워 업로드 대상에서 빼고 나머지 파일 삭제. .json이 남아 있으면 false
+static bool removeClip(uint32_t id) {
+  String meta = clipPath(id, "json");
+  bool removed = LittleFS.remove(meta) || !LittleFS.exists(meta);
+  LittleFS.remove(clipPath(id, "mp3"));
+  LittleFS.remove(clipPath(id, "idx"));
+  LittleFS.remove(clipPath(id, "tmp"));
+  return removed;
+}
+
+// 새 녹음에 필요한 공간이 생길 때까지 가장 오래된 클립부터 삭제
+static void ensureSpace(size_t need) {
+  xSemaphoreTake(spoolMutex, portMAX_DELAY);
+  while (freeBytes() < need) {
+    uint32_t id = oldestClip(uploadingId);
+    if (id == 0) break;
+    D_PRINTF("스풀 공간 부족: 클립 %lu 삭제\n", (unsigned long)id);
+    if (!removeClip(id)) {
+      D_PRINTF("클립 %lu 삭제 실패\n", (unsigned long)id);
+      break; // 같은 클립이 계속 선택되므로 중단
+    }
+    stats.evicted++;
+    if (stats.clips > 0) stats.clips--;
+  }
+  xSemaphoreGive(spoolMutex);
+}
+
+// 전원이 꺼져 완성되지 못한 파일 정리, 클립 수와 다음 번호 계산
+// 지울 수 없는 파일이 있어도 부팅이 멈추지 않도록 반복 횟수를 제한
+static void scanSpool() {
+  for (int pass = 0; pass < MAX_SCAN_PASSES; pass++) {
+    String orphans[MAX_ORPHANS];
+    int count = 0;
+    stats.clips = 0;
+
+    File dir = LittleFS.open(SPOOL_DIR);
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+      const char* name = f.name();
+      if (f.isDirectory()) {
+        if (pass == 0) D_PRINTF("스풀의 하위 디렉터리는 무시합니다: %s\n", name);
+        continue;
+      }
+      uint32_t id = strtoul(name, NULL, 10);
+      if (id >= nextId) nextId = id + 1;
+
+      const char* dot = strrchr(name, '.');
+      if (dot && strcmp(dot, ".json") == 0) {
+        stats.clips++;
+      } else if (!LittleFS.exists(clipPath(id, "json")) && count < MAX_ORPHANS) {
+        orphans[count++] = String(SPOOL_DIR) + "/" + name;
+      }
+    }
+    dir.close();
+
+    if (count == 0) return;
+    int removed = 0;
+    for (int i = 0; i < count; i++) {
+      if (LittleFS.remove(orphans[i])) {
+        D_PRINTF("미완성 스풀 파일 삭제: %s\n", orphans[i].c_str());
+        removed++;
+      } else {
+        D_PRINTF("미완성 스풀 파일 삭제 실패: %s\n", orphans[i].c_str());
+      }
+    }
+    if (removed == 0) return; // 다시 훑어도 같은 파일만 남음
+  }
+}
+
+static bool sendFile(ChunkedPost& post, const String& path) {
+  File f = LittleFS.open(path, FILE_READ);
+  if (!f) return false;
+  size_t n;
+  while ((n = f.read(uploadBuffer, sizeof(uploadBuffer))) > 0) {
+    if (!post.write(uploadBuffer, n)) break;
+  }
+  f.close();
+  return !post.failed();
+}
+
+// 녹음 시각(epoch)을 서버 형식(YYYYMMDDhhmmss)으로. 녹음 당시 시간이 동기화되지 않았으면 현재 시각
+static String formatDateTime(time_t ts) {
+  if (ts < 1600000000) return getCurrentDateTime();
+  struct tm timeinfo;
+  localtime_r(&ts, &timeinfo);
+  char timeString[15];
+  strftime(timeString, sizeof(timeString), "%Y%m%d%H%M%S", &timeinfo);
+  return String(timeString);
+}
+
+enum UploadResult {
+  UPLOAD_OK,
+  UPLOAD_RETRY,   // 네트워크/서버 문제, 백오프 후 재시도
+  UPLOAD_CORRUPT, // 다시 시도해도 소용없음, 클립 삭제
+};
+
+static UploadResult uploadClip(uint32_t id) {
+  JsonDocument meta;
+  File metaFile = LittleFS.open(clipPath(id, "json"), FILE_READ);
+  if (!metaFile) {
+    D_PRINTF("클립 %lu 메타데이터를 열 수 없어 삭제합니다.\n", (unsigned long)id);
+    return UPLOAD_CORRUPT;
+  }
+  DeserializationError err = deserializeJson(meta, metaFile);
+  metaFile.close();
+  if (err) {
+    D_PRINTF("클립 %lu 메타데이터 손상, 삭제합니다.\n", (unsigned long)id);
+    return UPLOAD_CORRUPT;
+  }
+
+  String boundary = "----WebKitFormBoundary7MA4YWxkTrZu0gW";
+  String dateTime = formatDateTime(meta["ts"].as<time_t>());
+  String name = String(device_id) + dateTime;
+  String clsJson, evJson;
+  serializeJson(meta["cls"], clsJson);
+  serializeJson(meta["ev"], evJson);
+
+  String head;
+  head += "--" + boundary + "\r\n";
+  head += "Content-Disposition: form-data; name=\"i\"\r\n\r\n" + String(device_id) + "\r\n";
+  head += "--" + boundary + "\r\n";
+  head += "Content-Disposition: form-data; name=\"d\"\r\n\r\n" + dateTime + "\r\n";
+  head += "--" + boundary + "\r\n";
+  head += "Content-Disposition: form-data; name=\"cls\"\r\n\r\n" + clsJson + "\r\n";
+  head += "--" + boundary + "\r\n";
+  head += "Content-Disposition: form-data; name=\"awfile\"; filename=\"" + name + ".mp3\"\r\n";
+  head += "Content-Type: audio/mpeg\r\n\r\n";
+  // MP3 뒤에 프레임 인덱스(오프셋/에너지/피크)를 별도 필드로 첨부
+  String indexHead;
+  indexHead += "\r\n--" + boundary + "\r\n";
+  indexHead += "Content-Disposition: form-data; name=\"awidx\"; filename=\"" + name + ".idx\"\r\n";
+  indexHead += "Content-Type: application/octet-stream\r\n\r\n";
+  // 이 녹음에 합쳐진 트리거 (원인, 녹음 시작 기준 시각)
+  String eventHead;
+  eventHead += "\r\n--" + boundary + "\r\n";
+  eventHead += "Content-Disposition: form-data; name=\"ev\"\r\n\r\n";
+  String tail = "\r\n--" + boundary + "--\r\n";
+
+  // 파일 크기를 알지만 기존과 같은 chunked 전송 경로를 그대로 사용
+  // 센서 업로드와 같은 keep-alive 연결을 사용하며, 재사용한 연결이 끊어져 있었으면 새 연결로 한 번 재시도
+  int code = HTTP_CONNECT_FAILED;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    WiFiClient* client = uplink.acquire();
+    if (!client) return UPLOAD_RETRY;
+
+    ChunkedPost post(*client);
+    post.begin(upload_file_path, "multipart/form-data; boundary=" + boundary);
+    post.write(head);
+    sendFile(post, clipPath(id, "mp3"));
+    if (LittleFS.exists(clipPath(id, "idx"))) {
+      post.write(indexHead);
+      sendFile(post, clipPath(id, "idx"));
+    }
+    post.write(eventHead);
+    post.write(evJson);
+    post.write(tail);
+    post.end();
+
+    code = post.failed() ? HTTP_SEND_FAILED : post.readResponse(UPLINK_TIMEOUT_MS);
+    bool stale = uplink.staleFailure(code); // 응답 시간 초과는 재전송하지 않음 (중복 업로드 방지)
+    uplink.release(code, post.keepAlive());
+    D_PRINTF("클립 %lu 업로드 %s (HTTP %d, %u bytes)\n", (unsigned long)id,
+             (code >= 200 && code < 300) ? "성공" : "실패", code, (unsigned)post.bodyBytes());
+    if (!stale) break;
+    uplink.noteStale();
+  }
+  return (code >= 200 && code < 300) ? UPLOAD_OK : UPLOAD_RETRY;
+}
+
+// 업로드 Task: 스풀이 빌 때까지 오래된 클립부터 업로드, 실패하면 지수 백오프
+static void uploader_task_function(void *pvParameters) {
+  uint32_t retryMs = SPOOL_RETRY_MIN_MS;
+  for (;;) {
+    xSemaphoreTake(spoolMutex, portMAX_DELAY);
+    uint32_t id = oldestClip(stuckId);
+    uploadingId = id;
+    xSemaphoreGive(spoolMutex);
+
+    if (id == 0) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // 새 클립이 완성될 때까지 대기
+      continue;
+    }
+
+    unsigned long started = millis();
+    UploadResult result = WiFi.status() == WL_CONNECTED ? uploadClip(id) : UPLOAD_RETRY;
+    uploadMs.observe(millis() - started);
+
+    xSemaphoreTake(spoolMutex, portMAX_DELAY);
+    uploadingId = 0;
+    if (result == UPLOAD_RETRY) {
+      stats.failures++;
+    } else {
+      if (!removeClip(id)) {
+        D_PRINTF("클립 %lu을 지울 수 없어 건너뜁니다.\n", (unsigned long)id);
+        stuckId = id;
+      }
+      if (result == UPLOAD_OK) stats.uploaded++;
+      else stats.corrupt++;
+      if (stats.clips > 0) stats.clips--;
+    }
+    xSemaphoreGive(spoolMutex);
+
+    bool ok = result != UPLOAD_RETRY; // 손상된 클립은 지웠으므로 바로 다음 클립으로
+    if (ok) {
+      retryMs = SPOOL_RETRY_MIN_MS;
+    } else {
+      D_PRINTF("업로드 실패, %lu초 후 재시도 (대기 중인 클립 %lu개)\n",
+               (unsigned long)(retryMs / 1000), (unsigned long)stats.clips);
+      vTaskDelay(pdMS_TO_TICKS(retryMs));
+      retryMs = min(retryMs * 2, SPOOL_RETRY_MAX_MS);
+    }
+  }
+}
+
+bool setupSpool() {
+  if (!LittleFS.begin(true)) {
+    D_PRINTLN("LittleFS 마운트 실패!");
+    return false;
+  }
+  if (!LittleFS.exists(SPOOL_DIR)) LittleFS.mkdir(SPOOL_DIR);
+
+  spoolMutex = xSemaphoreCreateMutex();
+  scanSpool();
+  D_PRINTF("스풀: 대기 중인 클립 %lu개, 여유 공간 %u bytes\n", (unsigned long)stats.clips, (unsigned)freeBytes());
+
+  xTaskCreatePinnedToCore(
+      uploader_task_function, // Task 함수
+      "Uploader Task",        // Task 이름
+      8192,                   // Stack 크기
+      NULL,                   // Task 파라미터
+      1,                      // 우선순위
+      &uploaderTaskHandle,    // Task 핸들
+      0);                     // Core 0에서 실행 (네트워크와 같은 코어)
+  spoolReady = uploaderTaskHandle != NULL;
+  return spoolReady;
+}
+
+bool SpoolClip::begin() {
+  abort();
+  if (!spoolReady) {
+    D_PRINTLN("스풀을 사용할 수 없습니다 (파일 시스템 마운트 실패).");
+    return false;
+  }
+  ensureSpace(SPOOL_RESERVE_BYTES);
+
+  xSemaphoreTake(spoolMutex, portMAX_DELAY);
+  id = nextId++;
+  xSemaphoreGive(spoolMutex);
+
+  file = LittleFS.open(clipPath(id, "mp3"), FILE_WRITE);
+  if (!file) {
+    D_PRINTLN("스풀 파일 생성 실패!");
+    return false;
+  }
+  open = true;
+  error = false;
+  written = 0;
+  buffered = 0;
+  return true;
+}
+
+bool SpoolClip::flushBuffer() {
+  if (buffered == 0) return true;
+  if (file.write(writeBuffer, buffered) != buffered) error = true;
+  buffered = 0;
+  return !error;
+}
+
+bool SpoolClip::write(const uint8_t* data, size_t len) {
+  if (!open || error) return false;
+  while (len > 0) {
+    size_t n = min(len, SPOOL_WRITE_BUFFER - buffered);
+    memcpy(writeBuffer + buffered, data, n);
+    buffered += n;
+    data += n;
+    len -= n;
+    written += n;
+    if (buffered == SPOOL_WRITE_BUFFER && !flushBuffer()) return false;
+  }
+  return true;
+}
+
+bool SpoolClip::commit(const uint8_t* index, size_t indexLen, const String& metaJson) {
+  if (!open) return false;
+  flushBuffer();
+  file.close();
+
+  if (!error && indexLen > 0) {
+    File f = LittleFS.open(clipPath(id, "idx"), FILE_WRITE);
+    if (!f || f.write(index, indexLen) != indexLen) error = true;
+    f.close();
+  }
+  // 메타데이터는 임시 파일에 쓴 뒤 이름을 바꿔, .json이 보이면 항상 완성된 클립이 되도록 함
+  if (!error) {
+    File f = LittleFS.open(clipPath(id, "tmp"), FILE_WRITE);
+    if (!f || f.write((const uint8_t*)metaJson.c_str(), metaJson.length()) != metaJson.length()) error = true;
+    f.close();
+  }
+  if (error || !LittleFS.rename(clipPath(id, "tmp"), clipPath(id, "json"))) {
+    D_PRINTLN("스풀 기록 실패, 클립을 버립니다.");
+    abort();
+    return false;
+  }
+  open = false;
+
+  xSemaphoreTake(spoolMutex, portMAX_DELAY);
+  stats.clips++;
+  xSemaphoreGive(spoolMutex);
+  D_PRINTF("클립 %lu 저장 완료 (%u bytes)\n", (unsigned long)id, (unsigned)written);
+
+  xTaskNotifyGive(uploaderTaskHandle);
+  return true;
+}
+
+void SpoolClip::abort() {
+  if (!open) return;
+  file.close();
+  removeClip(id);
+  open = false;
+}
@@ -0,0 +1,52 @@
+// spool.h
+
+#ifndef SPOOL_H
+#define SPOOL_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// 녹음 클립 저장 후 전송 (LittleFS)
+// 녹음은 인코딩되는 즉시 플래시에 기록되고, 업로드 Task가 스풀을 오래된 순서로 비웁니다.
+// 업로드에 실패하면 재시도 간격을 SPOOL_RETRY_MIN_MS부터 두 배씩 늘려 SPOOL_RETRY_MAX_MS까지 기다립니다.
+//
+// 클립 하나는 /spool/<번호>.mp3, <번호>.idx(프레임 인덱스), <번호>.json(메타데이터)로 이루어지며,
+// .json이 마지막에 만들어지므로 .json이 있는 클립만 완성된 것으로 봅니다.
+
+// 파일 시스템 마운트, 미완성 클립 정리, 업로드 Task 시작
+// 실패하면 false. 이후 SpoolClip::begin()이 실패하므로 녹음은 건너뜀
+bool setupSpool();
+
+// 녹음 중인 클립 하나. 인코더 출력을 버퍼링해 .mp3에 기록
+// 녹음은 Audio Task에서 한 번에 하나씩만 하므로 쓰기 버퍼는 모든 클립이 공유
+class SpoolClip {
+public:
+  SpoolClip() = default;
+  ~SpoolClip() { abort(); }
+
+  SpoolClip(const SpoolClip&) = delete;
+  SpoolClip& operator=(const SpoolClip&) = delete;
+
+  // 새 클립 파일 생성. 공간이 부족하면 가장 오래된 클립을 지움. 스풀을 사용할 수 없으면 false
+  bool begin();
+  bool write(const uint8_t* data, size_t len);
+  // 프레임 인덱스와 메타데이터(JSON)를 기록하고 업로드 대기열에 올림
+  bool commit(const uint8_t* index, size_t indexLen, const String& metaJson);
+  // 미완성 클립 삭제
+  void abort();
+
+  bool failed() const { return error; }
+  size_t bytes() const { return written; }
+
+private:
+  bool flushBuffer();
+
+  File file;
+  uint32_t id = 0;
+  bool open = false;
+  bool error = false;
+  size_t written = 0;
+  size_t buffered = 0;
+};
+
+#endif
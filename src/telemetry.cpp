@@ -0,0 +1,230 @@
+// telemetry.cpp
+
+#include "config.h"
+#include "telemetry.h"
+#include "network.h" // uplink
+#include "metrics.h"
+#include <esp_timer.h>
+
+// 샘플 하나 8바이트
+struct Sample {
+  uint16_t dt;   // 직전 샘플과의 시간 차 (초)
+  int16_t temp;  // 0.1°C
+  uint16_t humi; // 0.1%
+  uint16_t co2;  // ppm
+};
+
+static_assert((TELEMETRY_CAPACITY & (TELEMETRY_CAPACITY - 1)) == 0, "TELEMETRY_CAPACITY는 2의 거듭제곱이어야 합니다");
+
+static Sample ring[TELEMETRY_CAPACITY];
+static Sample sending[TELEMETRY_CAPACITY]; // 전송 중 링이 바뀌어도 되도록 복사해 둠 (전송 Task 전용)
+static uint32_t head = 0;     // 다음에 기록할 샘플 순번
+static uint32_t tail = 0;     // 가장 오래된 대기 샘플 순번, [tail, head)가 전송 대기
+static uint32_t tailTime = 0; // tail 샘플의 부팅 후 시각 (초)
+static uint32_t lastTime = 0; // 마지막 샘플의 부팅 후 시각 (초)
+static TelemetryStats stats = {};
+
+static Gauge pendingGauge("pet_telemetry_pending", "Sensor samples waiting for upload", nullptr,
+                          []() -> int32_t { return head - tail; });
+static Counter batchCounter("pet_telemetry_batches_total", "Sensor batches uploaded", nullptr,
+                            []() -> uint32_t { return stats.batches; });
+static Counter failureCounter("pet_telemetry_failures_total", "Sensor batch uploads that failed", nullptr,
+                              []() -> uint32_t { return stats.failures; });
+static Counter droppedCounter("pet_telemetry_dropped_total", "Sensor samples dropped because the ring was full", nullptr,
+                              []() -> uint32_t { return stats.dropped; });
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t telemetryTaskHandle = NULL;
+static bool useMsgPack = TELEMETRY_MSGPACK; // MessagePack은 거절하고 JSON은 받는 서버면 JSON으로 전환
+static bool useBatch = true; // 서버에 묶음 엔드포인트가 없으면(404/405) 기존 샘플별 엔드포인트로 전환
+
+// millis()는 49일마다 넘치므로 64비트 타이머 사용
+static uint32_t uptimeSeconds() {
+  return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+static int32_t fixed(float v, float scale, int32_t lo, int32_t hi) {
+  int32_t x = lroundf(v * scale);
+  return x < lo ? lo : (x > hi ? hi : x);
+}
+
+// 가장 오래된 샘플을 버림 (ringMux 안에서 호출)
+static void dropOldest() {
+  tail++;
+  if (tail != head) tailTime += ring[tail % TELEMETRY_CAPACITY].dt;
+}
+
+// 묶음 하나를 upload_telemetry_path로 전송하고 HTTP 상태 코드를 반환
+static int postBatch(JsonDocument& doc) {
+  String payload;
+  int code = -1;
+  bool tryJson = !useMsgPack;
+  if (useMsgPack) {
+    serializeMsgPack(doc, payload);
+    code = uplink.post(upload_telemetry_path, "application/msgpack", payload);
+    // 모르는 본문 형식을 415 대신 400/500 등으로 거절하는 서버도 있으므로, 응답이 온 거절이면 JSON으로 확인
+    tryJson = code >= 400;
+  }
+  if (tryJson) {
+    payload = "";
+    serializeJson(doc, payload);
+    code = uplink.post(upload_telemetry_path, "application/json", payload);
+    if (useMsgPack && code >= 200 && code < 300) {
+      D_PRINTLN("서버가 MessagePack을 받지 않아 JSON으로 전환합니다.");
+      useMsgPack = false;
+    }
+  }
+  D_PRINTF("센서 데이터 묶음 전송: HTTP %d, %u bytes\n", code, (unsigned)payload.length());
+  return code;
+}
+
+// 묶음 엔드포인트가 없는 서버용: 샘플마다 기존 형식으로 upload_sensor_path에 전송
+// 서버가 기대하는 형식 그대로 값은 문자열, 시각은 YYYYMMDDhhmmss. 앞에서부터 성공한 샘플 수를 반환
+static uint32_t postSamples(uint32_t count, time_t firstEpoch, int* code) {
+  time_t ts = firstEpoch;
+  for (uint32_t k = 0; k < count; k++) {
+    if (k > 0) ts += sending[k].dt;
+    struct tm timeinfo;
+    localtime_r(&ts, &timeinfo);
+    char dateTime[15];
+    strftime(dateTime, sizeof(dateTime), "%Y%m%d%H%M%S", &timeinfo);
+
+    JsonDocument doc;
+    doc["t"] = String(sending[k].temp / 10.0f, 1);
+    doc["h"] = String(sending[k].humi / 10.0f, 1);
+    doc["c"] = String(sending[k].co2);
+    doc["d"] = dateTime;
+    doc["i"] = device_id;
+    String payload;
+    serializeJson(doc, payload);
+    *code = uplink.post(upload_sensor_path, "application/json", payload);
+    if (*code < 200 || *code >= 300) return k;
+  }
+  return count;
+}
+
+// 대기 중인 샘플을 한 번에 전송. 성공하면 보낸 샘플을 링에서 지움
+static bool flushPending() {
+  portENTER_CRITICAL(&ringMux);
+  uint32_t from = tail, to = head, firstTime = tailTime;
+  for (uint32_t seq = from; seq != to; seq++) {
+    sending[seq - from] = ring[seq % TELEMETRY_CAPACITY];
+  }
+  portEXIT_CRITICAL(&ringMux);
+
+  uint32_t count = to - from;
+  if (count == 0) return true;
+
+  // 부팅 후 시각을 실제 시각으로 바꾸려면 NTP 동기화가 필요
+  time_t now = time(NULL);
+  if (now < 1600000000) {
+    D_PRINTLN("시간이 동기화되지 않아 센서 데이터 전송을 미룹니다.");
+    return false;
+  }
+
+  time_t firstEpoch = now - (uptimeSeconds() - firstTime);
+  uint32_t done = 0;
+  int code = -1;
+  if (useBatch) {
+    JsonDocument doc;
+    doc["i"] = device_id;
+    doc["b"] = (long)firstEpoch;
+    JsonArray rows = doc["s"].to<JsonArray>();
+    for (uint32_t k = 0; k < count; k++) {
+      JsonArray r = rows.add<JsonArray>();
+      r.add(k == 0 ? 0 : sending[k].dt);
+      r.add(sending[k].temp);
+      r.add(sending[k].humi);
+      r.add(sending[k].co2);
+    }
+    code = postBatch(doc);
+    if (code >= 200 && code < 300) {
+      done = count;
+    } else if (code == 404 || code == 405) {
+      D_PRINTLN("서버에 센서 묶음 엔드포인트가 없어 샘플별 전송으로 전환합니다.");
+      useBatch = false;
+    }
+  }
+  if (!useBatch) {
+    done = postSamples(count, firstEpoch, &code);
+  }
+  bool ok = done == count;
+  D_PRINTF("센서 데이터 %lu/%lu개 전송 %s (HTTP %d)\n", (unsigned long)done, (unsigned long)count,
+           ok ? "성공" : "실패", code);
+
+  portENTER_CRITICAL(&ringMux);
+  // 보낸 샘플만 지움. 전송 중 링이 넘쳐 이미 버려진 샘플은 건너뜀
+  uint32_t doneTo = from + done;
+  while ((int32_t)(doneTo - tail) > 0) dropOldest();
+  if (ok) {
+    stats.batches++;
+  } else {
+    stats.failures++;
+  }
+  portEXIT_CRITICAL(&ringMux);
+  return ok;
+}
+
+// 전송 Task: TELEMETRY_FLUSH_MS마다, 또는 telemetryFlush() 요청이 오면 전송
+static void telemetry_task_function(void *pvParameters) {
+  unsigned long lastFlush = millis();
+  for (;;) {
+    unsigned long elapsed = millis() - lastFlush;
+    uint32_t waitMs = elapsed < TELEMETRY_FLUSH_MS ? TELEMETRY_FLUSH_MS - elapsed : 0;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+
+    if (WiFi.status() != WL_CONNECTED) continue;
+    flushPending();
+    lastFlush = millis(); // 실패해도 다음 주기까지 기다림
+  }
+}
+
+void setupTelemetry() {
+  xTaskCreatePinnedToCore(
+      telemetry_task_function, // Task 함수
+      "Telemetry Task",        // Task 이름
+      6144,                    // Stack 크기
+      NULL,                    // Task 파라미터
+      1,                       // 우선순위
+      &telemetryTaskHandle,    // Task 핸들
+      0);                      // Core 0에서 실행
+}
+
+void telemetryAdd(float temp, float humi, float co2) {
+  Sample s;
+  s.temp = (int16_t)fixed(temp, 10, INT16_MIN, INT16_MAX);
+  s.humi = (uint16_t)fixed(humi, 10, 0, 1000);
+  s.co2 = (uint16_t)fixed(co2, 1, 0, UINT16_MAX);
+  uint32_t now = uptimeSeconds();
+
+  portENTER_CRITICAL(&ringMux);
+  if (head - tail == TELEMETRY_CAPACITY) {
+    dropOldest();
+    stats.dropped++;
+  }
+  if (head == tail) {
+    tailTime = now;
+    s.dt = 0;
+  } else {
+    s.dt = (uint16_t)min(now - lastTime, (uint32_t)UINT16_MAX);
+  }
+  ring[head % TELEMETRY_CAPACITY] = s;
+  head++;
+  lastTime = now;
+  stats.samples++;
+  bool full = head - tail >= TELEMETRY_FLUSH_AT;
+  portEXIT_CRITICAL(&ringMux);
+
+  if (full) telemetryFlush();
+}
+
+void telemetryFlush() {
+  if (telemetryTaskHandle) xTaskNotifyGive(telemetryTaskHandle);
+}
+
+TelemetryStats telemetryStats() {
+  portENTER_CRITICAL(&ringMux);
+  TelemetryStats copy = stats;
+  copy.pending = head - tail;
+  portEXIT_CRITICAL(&ringMux);
+  return copy;
+}
@@ -0,0 +1,40 @@
+// telemetry.h
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// 센서 데이터 일괄 업로드
+// 센서 값을 고정 소수점(온도/습도 0.1 단위, CO2 ppm)과 직전 샘플과의 시간 차(초)로 링에 모아 두었다가
+// 한 번의 요청으로 배열째 전송합니다. 전송 시점은 TELEMETRY_FLUSH_MS마다, 링이 TELEMETRY_FLUSH_AT개만큼 찼을 때,
+// 또는 telemetryFlush()로 요청했을 때(녹음, 강제 업로드 등)입니다.
+// 전송에 실패한 샘플은 링에 남아 다음 전송에 포함되며, 링이 가득 차면 가장 오래된 샘플부터 버립니다.
+//
+// 전송 형식 (MessagePack. 서버가 4xx/5xx로 거절하면 같은 묶음을 같은 구조의 JSON으로 다시 보내,
+// JSON이 받아들여지면 이후로는 JSON만 사용)
+//   {"i": 기기 ID, "b": 첫 샘플 시각(epoch 초), "s": [[직전 샘플과의 시간 차(초), 온도x10, 습도x10, CO2], ...]}
+//
+// 묶음 엔드포인트(upload_telemetry_path)는 업로드 서버에 새로 추가되어야 합니다. 서버가 404/405로 응답하면
+// 재부팅 전까지 기존 엔드포인트(upload_sensor_path)로 샘플마다 기존 형식 {"t","h","c","d","i"}을 보냅니다.
+
+struct TelemetryStats {
+  uint32_t samples; // 기록한 샘플 수
+  uint32_t pending; // 전송 대기 중인 샘플 수
+  uint32_t batches; // 전송 성공한 묶음 수
+  uint32_t failures;
+  uint32_t dropped; // 링이 가득 차 버린 샘플 수
+};
+
+// 링 초기화 및 전송 Task 시작
+void setupTelemetry();
+
+// 샘플 하나 기록 (co2는 ppm)
+void telemetryAdd(float temp, float humi, float co2);
+
+// 대기 중인 샘플을 바로 전송하도록 요청 (전송은 Task에서 하므로 바로 반환)
+void telemetryFlush();
+
+TelemetryStats telemetryStats();
+
+#endif
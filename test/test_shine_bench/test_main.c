@@ -0,0 +1,97 @@
+/* Shine 인코딩 속도 벤치마크
+ *
+ * 44.1kHz 모노 PCM BENCH_SECONDS초를 장치와 같은 방식(1024 샘플 단위,
+ * shine_stream_write)으로 인코딩하고 걸린 CPU 시간을 출력합니다.
+ * native(SHINE_MONO_MPEG_I)와 native_generic(범용 경로)에서 각각 실행해 비교:
+ *   pio test -e native -e native_generic -f test_shine_bench -v
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include <unity.h>
+
+#include "l3stream.h"
+
+#define BENCH_SECONDS 60
+#define BENCH_RUNS 5
+#define SAMPLE_RATE 44100
+#define BLOCK_SAMPLES 1024
+
+static int16_t pcm[SAMPLE_RATE]; /* 1초 분량을 반복해서 입력 */
+static long encodedBytes;
+
+static void countBytes(const unsigned char *data, int len, void *user) {
+  (void)data;
+  (void)user;
+  encodedBytes += len;
+}
+
+/* 440Hz 사인파 근사(삼각파) + 의사 난수 잡음. 실행마다 같은 입력 */
+static void fillPcm(void) {
+  uint32_t seed = 12345;
+  for (int i = 0; i < SAMPLE_RATE; i++) {
+    int phase = (i * 440 * 4 / SAMPLE_RATE) % 4;
+    int frac = (i * 440 * 4) % SAMPLE_RATE;
+    int tri = (phase & 1) ? SAMPLE_RATE - frac : frac;
+    if (phase >= 2) tri = -tri;
+    seed = seed * 1664525 + 1013904223;
+    pcm[i] = (int16_t)(tri * 8000 / SAMPLE_RATE + (int16_t)(seed >> 16) / 16);
+  }
+}
+
+/* BENCH_SECONDS초 인코딩에 걸린 CPU 시간 (ms) */
+static double encodeOnce(void) {
+  shine_config_t config;
+  shine_set_config_mpeg_defaults(&config.mpeg);
+  config.wave.samplerate = SAMPLE_RATE;
+  config.wave.channels = PCM_MONO;
+  config.mpeg.bitr = 128;
+  config.mpeg.mode = MONO;
+
+  shine_stream_t st = shine_stream_open(&config, countBytes, NULL);
+  TEST_ASSERT_NOT_NULL(st);
+
+  encodedBytes = 0;
+  clock_t start = clock();
+  for (int s = 0; s < BENCH_SECONDS; s++) {
+    for (int i = 0; i < SAMPLE_RATE; i += BLOCK_SAMPLES) {
+      int n = SAMPLE_RATE - i < BLOCK_SAMPLES ? SAMPLE_RATE - i : BLOCK_SAMPLES;
+      shine_stream_write(st, pcm + i, n);
+    }
+  }
+  shine_stream_flush(st);
+  clock_t end = clock();
+  shine_stream_close(st);
+
+  return (double)(end - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static void test_encode_speed(void) {
+  fillPcm();
+
+  double best = 0;
+  for (int run = 0; run < BENCH_RUNS; run++) {
+    double ms = encodeOnce();
+    if (run == 0 || ms < best) best = ms;
+  }
+
+  /* 128kbps로 인코딩됐는지 (비트 저장소 때문에 약간의 오차 허용) */
+  long expected = 128000L / 8 * BENCH_SECONDS;
+  TEST_ASSERT_INT_WITHIN(expected / 100, expected, encodedBytes);
+
+  char msg[128];
+#ifdef SHINE_MONO_MPEG_I
+  const char *build = "mono MPEG-I";
+#else
+  const char *build = "generic";
+#endif
+  snprintf(msg, sizeof(msg), "shine %s: %d s of PCM in %.1f ms (%.0fx realtime, best of %d)",
+           build, BENCH_SECONDS, best, BENCH_SECONDS * 1000.0 / best, BENCH_RUNS);
+  TEST_MESSAGE(msg);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_encode_speed);
+  return UNITY_END();
+}
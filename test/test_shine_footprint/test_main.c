@@ -0,0 +1,80 @@
+/* Shine 인코더 메모리 예산 테스트
+ *
+ * 장치와 같은 설정(44.1kHz 모노 128kbps)의 스트림 인코더로 프레임을 인코딩한 뒤
+ * shine_stream_get_footprint()의 총량(스트림 PCM 버퍼, 실제로 커진 비트스트림 버퍼 포함)이
+ * SHINE_RAM_BUDGET을 넘지 않는지 확인합니다.
+ *   pio test -e native -f test_shine_footprint
+ */
+
+#include <stdio.h>
+#include <unity.h>
+
+#include "l3stream.h"
+
+#define SAMPLE_RATE 44100
+#define BLOCK_SAMPLES 1024
+#define ENCODE_SECONDS 10
+
+static int16_t block[BLOCK_SAMPLES];
+
+static void discard(const unsigned char *data, int len, void *user) {
+  (void)data;
+  (void)len;
+  (void)user;
+}
+
+static shine_stream_t openMono(void) {
+  shine_config_t config;
+  shine_set_config_mpeg_defaults(&config.mpeg);
+  config.wave.samplerate = SAMPLE_RATE;
+  config.wave.channels = PCM_MONO;
+  config.mpeg.bitr = 128;
+  config.mpeg.mode = MONO;
+  return shine_stream_open(&config, discard, NULL);
+}
+
+static void printFootprint(const shine_footprint_t *fp) {
+  char msg[200];
+  snprintf(msg, sizeof(msg),
+           "total %d B (state %d, loop %d, subband %d, mdct %d, samples %d, "
+           "bitstream %d / high-water %d, stream %d), budget %d B",
+           fp->total, fp->state, fp->loop_tables, fp->subband, fp->mdct,
+           fp->samples, fp->bitstream, fp->bitstream_high_water, fp->stream,
+           SHINE_RAM_BUDGET);
+  TEST_MESSAGE(msg);
+}
+
+static void test_mono_encoder_fits_budget(void) {
+  shine_stream_t st = openMono();
+  TEST_ASSERT_NOT_NULL(st);
+
+  /* 최대 진폭 백색 잡음: 프레임당 비트가 가장 많이 필요해 비트스트림 버퍼가 가장 커짐 */
+  uint32_t seed = 1;
+  for (long done = 0; done < (long)SAMPLE_RATE * ENCODE_SECONDS; done += BLOCK_SAMPLES) {
+    for (int i = 0; i < BLOCK_SAMPLES; i++) {
+      seed = seed * 1664525 + 1013904223;
+      block[i] = (int16_t)(seed >> 16);
+    }
+    shine_stream_write(st, block, BLOCK_SAMPLES);
+  }
+  shine_stream_flush(st);
+
+  shine_footprint_t fp;
+  shine_stream_get_footprint(st, &fp);
+  shine_stream_close(st);
+  printFootprint(&fp);
+
+  TEST_ASSERT_GREATER_THAN(0, fp.stream);
+  TEST_ASSERT_GREATER_THAN(0, fp.bitstream_high_water);
+  TEST_ASSERT_LESS_OR_EQUAL(fp.bitstream, fp.bitstream_high_water);
+  TEST_ASSERT_EQUAL_INT(fp.state + fp.loop_tables + fp.subband + fp.mdct +
+                            fp.samples + fp.bitstream + fp.stream,
+                        fp.total);
+  TEST_ASSERT_LESS_OR_EQUAL(SHINE_RAM_BUDGET, fp.total);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_mono_encoder_fits_budget);
+  return UNITY_END();
+}